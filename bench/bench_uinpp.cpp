@@ -0,0 +1,216 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <benchmark/benchmark.h>
+
+#include <linux/input.h>
+
+#include "event_emitter.hpp"
+#include "event_sequence.hpp"
+#include "motion_sensor.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+// All benchmarks use DeviceBackend::NONE, so that the numbers show
+// the overhead of the library and not that of the kernel.
+
+namespace {
+
+uint32_t const joystick_id = uinpp::create_device_id(0, uinpp::DEVICEID_JOYSTICK);
+uint32_t const keyboard_id = uinpp::create_device_id(0, uinpp::DEVICEID_KEYBOARD);
+uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+
+void BM_KeyEmitterSend(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+  uinpp::EventEmitter* emitter = uinput.add_key(joystick_id, BTN_A);
+  uinput.finish();
+
+  int value = 0;
+  for (auto _ : state) {
+    emitter->send(value);
+    value ^= 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyEmitterSend);
+
+void BM_AbsEmitterSend(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+  uinpp::EventEmitter* emitter = uinput.add_abs(joystick_id, ABS_X, -32768, 32767, 0, 0, 0);
+  uinput.finish();
+
+  int value = 0;
+  for (auto _ : state) {
+    emitter->send(value);
+    value = (value + 1) & 0x7fff;
+    uinput.sync();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AbsEmitterSend);
+
+void BM_RelEmitterSend(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+  uinpp::EventEmitter* emitter = uinput.add_rel(mouse_id, REL_X);
+  uinput.finish();
+
+  int value = 1;
+  for (auto _ : state) {
+    emitter->send(value);
+    value = -value;
+    uinput.sync();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RelEmitterSend);
+
+/** many emitters feeding a single key, as with several buttons
+    mapped to the same key */
+void BM_KeyCollectorFanIn(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+
+  std::vector<uinpp::EventEmitter*> emitters;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    emitters.push_back(uinput.add_key(joystick_id, BTN_A));
+  }
+  uinput.finish();
+
+  for (auto _ : state)
+  {
+    for (uinpp::EventEmitter* emitter : emitters) {
+      emitter->send(1);
+    }
+    for (uinpp::EventEmitter* emitter : emitters) {
+      emitter->send(0);
+    }
+    uinput.sync();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_KeyCollectorFanIn)->RangeMultiplier(4)->Range(1, 256);
+
+/** sync() has to visit every collector, even if only one changed */
+void BM_MultiDeviceSync(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+
+  std::vector<uinpp::EventEmitter*> emitters;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    emitters.push_back(uinput.add_key(keyboard_id, KEY_ESC + static_cast<int>(i)));
+  }
+  uinput.finish();
+
+  int value = 0;
+  for (auto _ : state)
+  {
+    emitters.front()->send(value);
+    value ^= 1;
+    uinput.sync();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MultiDeviceSync)->RangeMultiplier(4)->Range(1, 1 << 8);
+
+void BM_RelRepeatUpdate(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+
+  std::vector<uinpp::Event> events;
+  for (int64_t i = 0; i < state.range(0); ++i)
+  {
+    // one device per repeater, as each device only has a few rel codes
+    uinpp::Event ev = uinpp::Event::create(static_cast<uint16_t>(i), EV_REL, REL_X);
+    ev.resolve_device_id(0, false);
+    uinput.add_rel(ev.get_device_id(), REL_X);
+    events.push_back(ev);
+  }
+  uinput.finish();
+
+  for (uinpp::Event const& ev : events) {
+    uinput.send_rel_repetitive(ev, 1.5f, 1);
+  }
+
+  for (auto _ : state)
+  {
+    uinput.update(1);
+    uinput.sync();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RelRepeatUpdate)->RangeMultiplier(4)->Range(1, 256);
+
+void BM_EventSequenceSend(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+
+  std::vector<uinpp::Event> sequence;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    sequence.push_back(uinpp::Event::create(uinpp::DEVICEID_KEYBOARD, EV_KEY, KEY_LEFTCTRL + static_cast<int>(i)));
+  }
+
+  uinpp::EventSequence event_sequence(sequence);
+  event_sequence.init(uinput, 0, true);
+  uinput.finish();
+
+  for (auto _ : state)
+  {
+    event_sequence.send(1);
+    uinput.sync();
+    event_sequence.send(0);
+    uinput.sync();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_EventSequenceSend)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+/** IMU samples per send_batch(), every axis changes in every sample */
+void BM_MotionSensorBatch(benchmark::State& state)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+  uinpp::MotionSensor sensor(uinput, joystick_id, uinpp::MotionSensorConfig{});
+  uinput.finish();
+
+  std::vector<uinpp::ImuSample> samples(static_cast<size_t>(state.range(0)));
+  uint32_t timestamp = 0;
+  for (auto _ : state)
+  {
+    for (uinpp::ImuSample& sample : samples)
+    {
+      timestamp += 1000;
+      int const v = static_cast<int>(timestamp & 0xff);
+      sample = uinpp::ImuSample{{v, v + 1, v + 2}, {v + 3, v + 4, v + 5}, timestamp};
+    }
+    sensor.send_batch(samples);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MotionSensorBatch)->Arg(1)->Arg(4)->Arg(16);
+
+} // namespace
+
+/* EOF */
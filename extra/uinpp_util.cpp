@@ -1,12 +1,833 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <getopt.h>
 #include <iostream>
 #include <linux/input.h>
+#include <poll.h>
+#include <string.h>
+#include <string_view>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <thread>
+#include <time.h>
 #include <unistd.h>
 
+#include <fmt/format.h>
+
+#include "event_emitter.hpp"
+#include "linux.hpp"
 #include "multi_device.hpp"
+#include "parse.hpp"
+#include "stats_region.hpp"
+
+namespace {
+
+void print_usage(char const* arg0)
+{
+  std::cout << "Usage: " << arg0 << " [COMMAND]\n"
+            << "\n"
+            << "Commands:\n"
+            << "  (none)              Create a keyboard that presses KEY_A once a second\n"
+            << "  stats [PID|NAME]..  Print the device stats of running uinpp processes,\n"
+            << "                      all of them if no PID or region NAME is given\n"
+            << "  load [OPTION]...    Drive virtual devices at a given event rate and\n"
+            << "                      report throughput, syscalls, CPU and latency\n"
+            << "  latency [OPTION]... Measure the time from send() until the events can be\n"
+            << "                      read back from /dev/input/eventN\n"
+            << "\n"
+            << "Load options:\n"
+            << "  --devices N         Number of devices (default: 1)\n"
+            << "  --keys N            Buttons per device, BTN_TRIGGER_HAPPY1 and up (default: 8)\n"
+            << "  --abs N             Absolute axes per device, ABS_X and up (default: 4)\n"
+            << "  --rels N            Relative axes per device, REL_X and up (default: 2)\n"
+            << "  --frame K,A,R       Key, abs and rel events per frame (default: 1,2,1)\n"
+            << "  --rate N            Target events per second over all devices,\n"
+            << "                      0 to run as fast as possible (default: 10000)\n"
+            << "  --duration SEC      Run time in seconds (default: 5)\n"
+            << "  --update MSEC       Call update() every MSEC of run time (default: 10)\n"
+            << "  --backend NAME      'uinput', 'loopback' or 'none' (default: loopback)\n"
+            << "\n"
+            << "Latency options:\n"
+            << "  --samples N         Frames per configuration (default: 1000)\n"
+            << "  --frame-sizes N,..  Abs events per frame (default: 1,4,16)\n"
+            << "  --backend NAME      'uinput' or 'loopback', default is uinput with\n"
+            << "                      a fallback to loopback when uinput isn't available\n"
+            << "\n"
+            << "Each frame size is measured with a sync() per frame and per event, and\n"
+            << "with the reader spinning, blocking in poll() or running in its own thread.\n";
+}
+
+void print_histogram(std::string_view name, uinpp::LatencyHistogram const& histogram)
+{
+  uint64_t const count = histogram.get_count();
+  std::cout << fmt::format("    {:<16} count: {}  mean: {}ns  p50: <{}ns  p99: <{}ns  p99.9: <{}ns\n",
+                           name, count,
+                           count ? histogram.get_sum() / count : 0,
+                           histogram.get_percentile(0.5) + 1,
+                           histogram.get_percentile(0.99) + 1,
+                           histogram.get_percentile(0.999) + 1);
+}
+
+void print_stats_region(uinpp::StatsRegion const& region)
+{
+  uinpp::StatsRegion::Layout const& layout = region.get_layout();
+
+  std::cout << fmt::format("{} (pid {})\n", region.get_name(), layout.pid);
+
+  for (uinpp::StatsRegion::Slot const& slot : layout.slots)
+  {
+    if (slot.in_use.load(std::memory_order_acquire) != 1) {
+      continue;
+    }
+
+    uinpp::DeviceStats const& stats = slot.stats;
+    auto get = [](std::atomic<uint64_t> const& counter) {
+      return counter.load(std::memory_order_relaxed);
+    };
+
+    std::cout << fmt::format("  {:#x} '{}'\n", slot.device_id, slot.name)
+              << fmt::format("    events written:  {:>12}  bytes: {}  write calls: {}  syncs: {}\n",
+                             get(stats.events_written), get(stats.bytes_written),
+                             get(stats.write_calls), get(stats.syncs))
+              << fmt::format("    dropped frames:  {:>12}  dropped events: {}  retried events: {}\n",
+                             get(stats.dropped_frames), get(stats.dropped_events),
+                             get(stats.retried_events))
+              << fmt::format("    read events:     {:>12}  read calls: {}  ff uploads: {}  ff erases: {}\n",
+                             get(stats.read_events), get(stats.read_calls),
+                             get(stats.ff_uploads), get(stats.ff_erases))
+              << fmt::format("    coalesced:       {:>12}\n", get(stats.coalesced_events));
+    print_histogram("send latency", stats.send_latency);
+    print_histogram("update duration", stats.update_duration);
+  }
+}
+
+int run_stats(int argc, char** argv)
+{
+  std::vector<std::string> names;
+  for (int i = 0; i < argc; ++i)
+  {
+    std::string_view const arg = argv[i];
+    if (!arg.empty() && arg.find_first_not_of("0123456789") == std::string_view::npos) {
+      names.emplace_back(uinpp::StatsRegion::get_default_name(std::stoi(std::string(arg))));
+    } else {
+      names.emplace_back(arg.starts_with('/') ? std::string(arg) : "/" + std::string(arg));
+    }
+  }
+
+  if (names.empty())
+  {
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator("/dev/shm", ec))
+    {
+      std::string const filename = entry.path().filename().string();
+      if (filename.starts_with("uinpp-")) {
+        names.emplace_back("/" + filename);
+      }
+    }
+  }
+
+  int ret = 0;
+  for (std::string const& name : names)
+  {
+    try
+    {
+      print_stats_region(*uinpp::StatsRegion::open(name));
+    }
+    catch (std::exception const& err)
+    {
+      std::cerr << "error: " << err.what() << std::endl;
+      ret = 1;
+    }
+  }
+  return ret;
+}
+
+struct LoadOptions
+{
+  int devices = 1;
+  int keys = 8;
+  int abses = 4;
+  int rels = 2;
+  int frame_keys = 1;
+  int frame_abses = 2;
+  int frame_rels = 1;
+  int rate = 10000;
+  double duration = 5.0;
+  int update_msec = 10;
+  uinpp::DeviceBackend backend = uinpp::DeviceBackend::LOOPBACK;
+};
+
+LoadOptions parse_load_options(int argc, char** argv)
+{
+  enum { DEVICES = 256, KEYS, ABS, RELS, FRAME, RATE, DURATION, UPDATE, BACKEND };
+  static option const long_options[] = {
+    { "devices", required_argument, nullptr, DEVICES },
+    { "keys", required_argument, nullptr, KEYS },
+    { "abs", required_argument, nullptr, ABS },
+    { "rels", required_argument, nullptr, RELS },
+    { "frame", required_argument, nullptr, FRAME },
+    { "rate", required_argument, nullptr, RATE },
+    { "duration", required_argument, nullptr, DURATION },
+    { "update", required_argument, nullptr, UPDATE },
+    { "backend", required_argument, nullptr, BACKEND },
+    { nullptr, 0, nullptr, 0 }
+  };
+
+  LoadOptions opts;
+  optind = 1;
+  int c;
+  while ((c = getopt_long(argc, argv, "", long_options, nullptr)) != -1)
+  {
+    switch (c)
+    {
+      case DEVICES: opts.devices = std::stoi(optarg); break;
+      case KEYS: opts.keys = std::stoi(optarg); break;
+      case ABS: opts.abses = std::stoi(optarg); break;
+      case RELS: opts.rels = std::stoi(optarg); break;
+      case RATE: opts.rate = std::stoi(optarg); break;
+      case DURATION: opts.duration = std::stod(optarg); break;
+      case UPDATE: opts.update_msec = std::stoi(optarg); break;
+
+      case FRAME:
+        if (sscanf(optarg, "%d,%d,%d", &opts.frame_keys, &opts.frame_abses, &opts.frame_rels) != 3) {
+          throw std::runtime_error(fmt::format("invalid frame composition: {}", optarg));
+        }
+        break;
+
+      case BACKEND:
+        if (std::string_view(optarg) == "uinput") {
+          opts.backend = uinpp::DeviceBackend::UINPUT;
+        } else if (std::string_view(optarg) == "loopback") {
+          opts.backend = uinpp::DeviceBackend::LOOPBACK;
+        } else if (std::string_view(optarg) == "none") {
+          opts.backend = uinpp::DeviceBackend::NONE;
+        } else {
+          throw std::runtime_error(fmt::format("unknown backend: {}", optarg));
+        }
+        break;
+
+      default:
+        throw std::runtime_error("invalid load option");
+    }
+  }
+
+  if (opts.devices < 1 ||
+      opts.keys < 0 || opts.keys > BTN_TRIGGER_HAPPY40 - BTN_TRIGGER_HAPPY1 + 1 ||
+      opts.abses < 0 || opts.abses > ABS_MISC ||
+      opts.rels < 0 || opts.rels > REL_MISC ||
+      (opts.frame_keys > 0 && opts.keys == 0) ||
+      (opts.frame_abses > 0 && opts.abses == 0) ||
+      (opts.frame_rels > 0 && opts.rels == 0) ||
+      opts.frame_keys + opts.frame_abses + opts.frame_rels < 1)
+  {
+    throw std::runtime_error("invalid device capabilities or frame composition");
+  }
+
+  return opts;
+}
+
+uint64_t cpu_nsec()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000 +
+    static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000;
+}
+
+void add_histogram(std::vector<uint64_t>& buckets, uinpp::LatencyHistogram const& histogram)
+{
+  for (int i = 0; i < uinpp::LatencyHistogram::BUCKETS; ++i) {
+    buckets[static_cast<size_t>(i)] += histogram.get_bucket(i);
+  }
+}
+
+/** upper bound of the bucket holding \a quantile, see LatencyHistogram::get_percentile() */
+uint64_t get_percentile(std::vector<uint64_t> const& buckets, double quantile)
+{
+  uint64_t count = 0;
+  for (uint64_t n : buckets) {
+    count += n;
+  }
+
+  uint64_t const rank = count ? static_cast<uint64_t>(quantile * static_cast<double>(count - 1)) : 0;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i)
+  {
+    seen += buckets[i];
+    if (seen > rank) {
+      return uint64_t{1} << (i + 1);
+    }
+  }
+  return 0;
+}
+
+int run_load(int argc, char** argv)
+{
+  LoadOptions const opts = parse_load_options(argc, argv);
+
+  struct LoadDevice
+  {
+    uint32_t device_id;
+    std::vector<uinpp::EventEmitter*> keys;
+    std::vector<uinpp::EventEmitter*> abses;
+    std::vector<uinpp::EventEmitter*> rels;
+
+    /** last value send per emitter, every send changes it, so that
+        nothing gets filtered as a duplicate
+        @{*/
+    std::vector<int> key_values;
+    std::vector<int> abs_values;
+    std::vector<int> rel_values;
+    /** @} */
+  };
+
+  uinpp::MultiDevice uinput;
+  uinput.set_extra_events(false);
+  uinput.set_backend(opts.backend);
+
+  std::vector<LoadDevice> devices;
+  for (int i = 0; i < opts.devices; ++i)
+  {
+    LoadDevice dev;
+    dev.device_id = static_cast<uint32_t>(i);
+    uinput.set_device_name(dev.device_id, fmt::format("uinpp load generator #{}", i));
+
+    for (int code = 0; code < opts.keys; ++code) {
+      dev.keys.push_back(uinput.add_key(dev.device_id, BTN_TRIGGER_HAPPY1 + code));
+    }
+    for (int code = 0; code < opts.abses; ++code) {
+      dev.abses.push_back(uinput.add_abs(dev.device_id, ABS_X + code, -32768, 32767, 0, 0, 0));
+    }
+    for (int code = 0; code < opts.rels; ++code) {
+      dev.rels.push_back(uinput.add_rel(dev.device_id, REL_X + code));
+    }
+    dev.key_values.resize(dev.keys.size(), 0);
+    dev.abs_values.resize(dev.abses.size(), 0);
+    dev.rel_values.resize(dev.rels.size(), -1);
+    devices.push_back(std::move(dev));
+  }
+
+  uinput.finish();
+  std::vector<uinpp::Device*> const kernel_devices = uinput.get_devices();
+
+  int const frame_events = opts.frame_keys + opts.frame_abses + opts.frame_rels;
+
+  // one tick sends a frame to every device
+  std::chrono::nanoseconds const tick_interval =
+    opts.rate > 0 ?
+    std::chrono::nanoseconds(1000000000LL * frame_events * opts.devices / opts.rate) :
+    std::chrono::nanoseconds(0);
+
+  uinpp::LatencyHistogram frame_latency;
+  std::vector<char> drain_buffer(64 * 1024);
+
+  uint64_t frames = 0;
+  size_t rotation = 0;
+
+  uint64_t const cpu_start = cpu_nsec();
+  auto const start = std::chrono::steady_clock::now();
+  auto const end = start + std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::duration<double>(opts.duration));
+  auto next_tick = start;
+  auto next_update = start + std::chrono::milliseconds(opts.update_msec);
+
+  while (true)
+  {
+    auto const now = std::chrono::steady_clock::now();
+    if (now >= end) {
+      break;
+    }
+
+    for (LoadDevice& dev : devices)
+    {
+      auto const frame_start = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < static_cast<size_t>(opts.frame_keys); ++i) {
+        size_t const idx = (rotation + i) % dev.keys.size();
+        dev.key_values[idx] ^= 1;
+        dev.keys[idx]->send(dev.key_values[idx]);
+      }
+      for (size_t i = 0; i < static_cast<size_t>(opts.frame_abses); ++i) {
+        size_t const idx = (rotation + i) % dev.abses.size();
+        dev.abs_values[idx] = (dev.abs_values[idx] + 1) % 32768;
+        dev.abses[idx]->send(dev.abs_values[idx]);
+      }
+      for (size_t i = 0; i < static_cast<size_t>(opts.frame_rels); ++i) {
+        size_t const idx = (rotation + i) % dev.rels.size();
+        dev.rel_values[idx] = -dev.rel_values[idx];
+        dev.rels[idx]->send(dev.rel_values[idx]);
+      }
+      uinput.sync();
+
+      frame_latency.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - frame_start).count()));
+
+      frames += 1;
+    }
+    rotation += 1;
+
+    if (opts.update_msec > 0 && now >= next_update)
+    {
+      uinput.update(opts.update_msec);
+      next_update += std::chrono::milliseconds(opts.update_msec);
+    }
+
+    for (uinpp::Device* device : kernel_devices)
+    {
+      device->read();
+      if (device->get_loopback_fd() >= 0) {
+        while (::read(device->get_loopback_fd(), drain_buffer.data(), drain_buffer.size()) > 0) {}
+      }
+    }
+
+    if (tick_interval.count() > 0)
+    {
+      next_tick += tick_interval;
+      if (next_tick > std::chrono::steady_clock::now())
+      {
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(next_tick.time_since_epoch()).count();
+        timespec const ts{ static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+      }
+    }
+  }
+
+  double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  uint64_t const cpu = cpu_nsec() - cpu_start;
+
+  uint64_t events_written = 0;
+  uint64_t syncs = 0;
+  uint64_t write_calls = 0;
+  uint64_t dropped_events = 0;
+  std::vector<uint64_t> send_latency(uinpp::LatencyHistogram::BUCKETS);
+  for (uinpp::Device* device : kernel_devices)
+  {
+    uinpp::DeviceStats const& stats = device->get_stats();
+    events_written += stats.events_written;
+    syncs += stats.syncs;
+    write_calls += stats.write_calls;
+    dropped_events += stats.dropped_events;
+    add_histogram(send_latency, stats.send_latency);
+  }
+
+  std::vector<uint64_t> frame_buckets(uinpp::LatencyHistogram::BUCKETS);
+  add_histogram(frame_buckets, frame_latency);
+
+  std::cout << fmt::format("devices:           {} ({})\n", opts.devices,
+                           opts.backend == uinpp::DeviceBackend::UINPUT ? "uinput" :
+                           opts.backend == uinpp::DeviceBackend::LOOPBACK ? "loopback" : "none")
+            << fmt::format("frame:             {} keys, {} abs, {} rels\n",
+                           opts.frame_keys, opts.frame_abses, opts.frame_rels)
+            << fmt::format("target rate:       {}\n",
+                           opts.rate > 0 ? fmt::format("{} events/s", opts.rate) : "unlimited")
+            << fmt::format("frames:            {} send, {} synced\n", frames, syncs)
+            << fmt::format("achieved rate:     {:.0f} events/s, {:.0f} frames/s (written, without SYN_REPORT)\n",
+                           static_cast<double>(events_written - syncs) / elapsed,
+                           static_cast<double>(syncs) / elapsed)
+            << fmt::format("dropped events:    {}\n", dropped_events)
+            << fmt::format("syscalls/frame:    {:.3f} write()\n",
+                           syncs ? static_cast<double>(write_calls) / static_cast<double>(syncs) : 0.0)
+            << fmt::format("CPU/event:         {:.0f}ns (including draining the loopback)\n",
+                           events_written ? static_cast<double>(cpu) / static_cast<double>(events_written) : 0.0)
+            << fmt::format("frame latency:     p50 <{}ns  p99 <{}ns  p99.9 <{}ns  (send() to sync() return)\n",
+                           get_percentile(frame_buckets, 0.5),
+                           get_percentile(frame_buckets, 0.99),
+                           get_percentile(frame_buckets, 0.999))
+            << fmt::format("send latency:      p50 <{}ns  p99 <{}ns  p99.9 <{}ns  (first event to write())\n",
+                           get_percentile(send_latency, 0.5),
+                           get_percentile(send_latency, 0.99),
+                           get_percentile(send_latency, 0.999));
+
+  return 0;
+}
+
+enum class SyncMode { FRAME, EVENT };
+enum class LoopMode { SPIN, POLL, THREAD };
+
+char const* to_string(SyncMode mode)
+{
+  return mode == SyncMode::FRAME ? "frame" : "event";
+}
 
-int main()
+char const* to_string(LoopMode mode)
 {
+  switch (mode)
+  {
+    case LoopMode::SPIN: return "spin";
+    case LoopMode::POLL: return "poll";
+    default: return "thread";
+  }
+}
+
+struct LatencyOptions
+{
+  int samples = 1000;
+  std::vector<int> frame_sizes = { 1, 4, 16 };
+  bool fallback = true;
+  uinpp::DeviceBackend backend = uinpp::DeviceBackend::UINPUT;
+};
+
+LatencyOptions parse_latency_options(int argc, char** argv)
+{
+  enum { SAMPLES = 256, FRAME_SIZES, BACKEND };
+  static option const long_options[] = {
+    { "samples", required_argument, nullptr, SAMPLES },
+    { "frame-sizes", required_argument, nullptr, FRAME_SIZES },
+    { "backend", required_argument, nullptr, BACKEND },
+    { nullptr, 0, nullptr, 0 }
+  };
+
+  LatencyOptions opts;
+  optind = 1;
+  int c;
+  while ((c = getopt_long(argc, argv, "", long_options, nullptr)) != -1)
+  {
+    switch (c)
+    {
+      case SAMPLES:
+        opts.samples = std::stoi(optarg);
+        break;
+
+      case FRAME_SIZES:
+        opts.frame_sizes = uinpp::parse_int_list(optarg);
+        break;
+
+      case BACKEND:
+        opts.fallback = false;
+        if (std::string_view(optarg) == "uinput") {
+          opts.backend = uinpp::DeviceBackend::UINPUT;
+        } else if (std::string_view(optarg) == "loopback") {
+          opts.backend = uinpp::DeviceBackend::LOOPBACK;
+        } else {
+          throw std::runtime_error(fmt::format("unknown backend: {}", optarg));
+        }
+        break;
+
+      default:
+        throw std::runtime_error("invalid latency option");
+    }
+  }
+
+  for (int size : opts.frame_sizes) {
+    if (size < 1 || size > ABS_MISC) {
+      throw std::runtime_error(fmt::format("frame size out of range: {}", size));
+    }
+  }
+
+  return opts;
+}
+
+/** Owns a file descriptor and closes it on destruction, -1 for none */
+class FileDescriptor
+{
+public:
+  explicit FileDescriptor(int fd = -1) : m_fd(fd) {}
+  ~FileDescriptor() { if (m_fd >= 0) { ::close(m_fd); } }
+
+  int get() const { return m_fd; }
+
+private:
+  int m_fd;
+
+private:
+  FileDescriptor(FileDescriptor const&) = delete;
+  FileDescriptor& operator=(FileDescriptor const&) = delete;
+};
+
+uint64_t steady_nsec()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** Reads events from the evdev node or the loopback socket and counts
+    the SYN_REPORTs, which mark a frame as seen by the consumer */
+class FrameReader
+{
+public:
+  FrameReader(int fd) :
+    m_fd(fd),
+    m_syns(0),
+    m_kernel_time(0)
+  {}
+
+  /** read what is available, returns false on error */
+  bool read_available()
+  {
+    input_event events[64];
+    ssize_t ret;
+    while ((ret = ::read(m_fd, events, sizeof(events))) > 0)
+    {
+      for (size_t i = 0; i < static_cast<size_t>(ret) / sizeof(input_event); ++i)
+      {
+        if (events[i].type == EV_SYN && events[i].code == SYN_REPORT)
+        {
+          m_syns += 1;
+          // zero for the loopback, the kernel stamps the evdev events
+          m_kernel_time = static_cast<uint64_t>(events[i].input_event_sec) * 1000000000 +
+            static_cast<uint64_t>(events[i].input_event_usec) * 1000;
+        }
+      }
+    }
+    return ret < 0 && errno == EAGAIN;
+  }
+
+  /** block or spin until \a syns SYN_REPORTs have been seen in total */
+  bool wait_for(uint64_t syns, bool spin)
+  {
+    uint64_t const timeout = steady_nsec() + 1000000000;
+    while (m_syns < syns)
+    {
+      if (!spin)
+      {
+        pollfd pfd{ m_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 1000) <= 0) {
+          return false;
+        }
+      }
+      else if (steady_nsec() > timeout)
+      {
+        return false;
+      }
+
+      if (!read_available()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint64_t get_syns() const { return m_syns; }
+  uint64_t get_kernel_time() const { return m_kernel_time; }
+
+private:
+  int m_fd;
+  uint64_t m_syns;
+  uint64_t m_kernel_time;
+};
+
+struct LatencyResult
+{
+  std::vector<uint64_t> total;
+  std::vector<uint64_t> to_kernel;
+};
+
+LatencyResult measure_latency(uinpp::MultiDevice& uinput, std::vector<uinpp::EventEmitter*> const& axes,
+                              int fd, int samples, int frame_size, SyncMode sync_mode, LoopMode loop_mode,
+                              int& value)
+{
+  LatencyResult result;
+  result.total.reserve(static_cast<size_t>(samples));
+
+  uint64_t const syns_per_frame = sync_mode == SyncMode::FRAME ? 1 : static_cast<uint64_t>(frame_size);
+
+  FrameReader reader(fd);
+  reader.read_available();
+
+  // in THREAD mode a separate consumer blocks on the fd, as a real
+  // client of the device would, jthread stops and joins it on every
+  // way out of here, including exceptions
+  std::atomic<uint64_t> seen_syns = 0;
+  std::atomic<uint64_t> seen_time = 0;
+  std::atomic<uint64_t> seen_kernel_time = 0;
+  std::jthread consumer;
+  if (loop_mode == LoopMode::THREAD)
+  {
+    consumer = std::jthread([&](std::stop_token stop){
+      FrameReader thread_reader(fd);
+      while (!stop.stop_requested())
+      {
+        pollfd pfd{ fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) > 0)
+        {
+          thread_reader.read_available();
+          seen_time = steady_nsec();
+          seen_kernel_time = thread_reader.get_kernel_time();
+          seen_syns = thread_reader.get_syns();
+        }
+      }
+    });
+  }
+
+  for (int sample = 0; sample < samples; ++sample)
+  {
+    // the value has to change every frame, the kernel drops
+    // unchanged abs events and empty frames
+    value += 1;
+
+    uint64_t const target = (loop_mode == LoopMode::THREAD ? seen_syns.load() : reader.get_syns()) + syns_per_frame;
+    uint64_t const start = steady_nsec();
+
+    for (int i = 0; i < frame_size; ++i)
+    {
+      axes[static_cast<size_t>(i)]->send(value);
+      if (sync_mode == SyncMode::EVENT) {
+        uinput.sync();
+      }
+    }
+    if (sync_mode == SyncMode::FRAME) {
+      uinput.sync();
+    }
+
+    uint64_t end;
+    uint64_t kernel_time;
+    if (loop_mode == LoopMode::THREAD)
+    {
+      uint64_t const timeout = start + 1000000000;
+      while (seen_syns < target && steady_nsec() < timeout) {}
+      if (seen_syns < target) {
+        throw std::runtime_error("timeout waiting for events");
+      }
+      end = seen_time;
+      kernel_time = seen_kernel_time;
+    }
+    else
+    {
+      if (!reader.wait_for(target, loop_mode == LoopMode::SPIN)) {
+        throw std::runtime_error("timeout waiting for events");
+      }
+      end = steady_nsec();
+      kernel_time = reader.get_kernel_time();
+    }
+
+    result.total.push_back(end - start);
+    if (kernel_time > start) {
+      result.to_kernel.push_back(kernel_time - start);
+    }
+  }
+
+  return result;
+}
+
+uint64_t get_sample_percentile(std::vector<uint64_t>& values, double quantile)
+{
+  if (values.empty()) {
+    return 0;
+  }
+
+  size_t const rank = static_cast<size_t>(quantile * static_cast<double>(values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + static_cast<ptrdiff_t>(rank), values.end());
+  return values[rank];
+}
+
+int run_latency(int argc, char** argv)
+{
+  LatencyOptions const opts = parse_latency_options(argc, argv);
+  int const axis_count = *std::max_element(opts.frame_sizes.begin(), opts.frame_sizes.end());
+
+  auto create = [&](uinpp::DeviceBackend backend) {
+    auto uinput = std::make_unique<uinpp::MultiDevice>();
+    std::vector<uinpp::EventEmitter*> axes;
+
+    uinput->set_extra_events(false);
+    uinput->set_backend(backend);
+    uinput->set_device_name(0, "uinpp latency harness");
+    for (int i = 0; i < axis_count; ++i) {
+      axes.push_back(uinput->add_abs(0, ABS_X + i, -32768, 32767, 0, 0, 0));
+    }
+    uinput->finish();
+    return std::make_pair(std::move(uinput), std::move(axes));
+  };
+
+  uinpp::DeviceBackend backend = opts.backend;
+  std::unique_ptr<uinpp::MultiDevice> uinput;
+  std::vector<uinpp::EventEmitter*> axes;
+  try
+  {
+    std::tie(uinput, axes) = create(backend);
+  }
+  catch (std::exception const& err)
+  {
+    if (!opts.fallback) {
+      throw;
+    }
+
+    std::cerr << "uinput not available, falling back to the loopback backend\n";
+    backend = uinpp::DeviceBackend::LOOPBACK;
+    std::tie(uinput, axes) = create(backend);
+  }
+
+  uinpp::Device* device = uinput->get_devices().front();
+
+  // the evdev node is ours to close, the loopback socket belongs to the device
+  std::unique_ptr<FileDescriptor> evdev;
+  int fd;
+  if (backend == uinpp::DeviceBackend::UINPUT)
+  {
+    std::string const path = device->get_evdev_path();
+    if (path.empty()) {
+      throw std::runtime_error(fmt::format("{}: device has no evdev node", device->get_name()));
+    }
+    if (!uinpp::wait_for_device_node(path, std::chrono::seconds(5))) {
+      throw std::runtime_error(fmt::format("{}: device node didn't become accessible", path));
+    }
+
+    fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::runtime_error(fmt::format("{}: {}", path, strerror(errno)));
+    }
+    evdev = std::make_unique<FileDescriptor>(fd);
+
+    // keep the events away from the rest of the system and use the
+    // same clock as the harness for the kernel timestamps
+    ioctl(fd, EVIOCGRAB, 1);
+    int clock = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+
+    std::cout << fmt::format("device: {} (uinput)\n", path);
+  }
+  else
+  {
+    fd = device->get_loopback_fd();
+    std::cout << "device: loopback socket, stand-in for the evdev node\n";
+  }
+
+  std::cout << fmt::format("{:>5} {:>6} {:>7} {:>8} {:>8} {:>8} {:>8} {:>10}\n",
+                           "frame", "sync", "loop", "p50", "p90", "p99", "max", "to kernel")
+            << fmt::format("{:>5} {:>6} {:>7} {:>8} {:>8} {:>8} {:>8} {:>10}\n",
+                           "", "", "", "[us]", "[us]", "[us]", "[us]", "p50 [us]");
+
+  int value = 0;
+  for (int frame_size : opts.frame_sizes)
+  {
+    for (SyncMode sync_mode : { SyncMode::FRAME, SyncMode::EVENT })
+    {
+      if (sync_mode == SyncMode::EVENT && frame_size == 1) {
+        continue;
+      }
+
+      for (LoopMode loop_mode : { LoopMode::SPIN, LoopMode::POLL, LoopMode::THREAD })
+      {
+        LatencyResult result = measure_latency(*uinput, axes, fd, opts.samples, frame_size,
+                                               sync_mode, loop_mode, value);
+
+        auto usec = [](uint64_t nsec) { return static_cast<double>(nsec) / 1000.0; };
+        std::cout << fmt::format("{:>5} {:>6} {:>7} {:>8.1f} {:>8.1f} {:>8.1f} {:>8.1f} {:>10}\n",
+                                 frame_size, to_string(sync_mode), to_string(loop_mode),
+                                 usec(get_sample_percentile(result.total, 0.5)),
+                                 usec(get_sample_percentile(result.total, 0.9)),
+                                 usec(get_sample_percentile(result.total, 0.99)),
+                                 usec(get_sample_percentile(result.total, 1.0)),
+                                 result.to_kernel.empty() ? std::string("-") :
+                                 fmt::format("{:.1f}", usec(get_sample_percentile(result.to_kernel, 0.5))));
+      }
+    }
+  }
+
+  return 0;
+}
+
+int run_demo()
+{
+  auto stats_region = uinpp::StatsRegion::create(uinpp::StatsRegion::get_default_name(getpid()));
+
   uinpp::MultiDevice device;
+  device.set_stats_region(stats_region.get());
   device.add_key(uinpp::DEVICEID_KEYBOARD, KEY_A);
   device.finish();
 
@@ -21,4 +842,32 @@ int main()
   return 0;
 }
 
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string_view const command = argc > 1 ? argv[1] : "";
+
+  if (argc == 1) {
+    return run_demo();
+  } else if (command == "stats") {
+    return run_stats(argc - 2, argv + 2);
+  } else if (command == "load" || command == "latency") {
+    try
+    {
+      return command == "load" ?
+        run_load(argc - 1, argv + 1) :
+        run_latency(argc - 1, argv + 1);
+    }
+    catch (std::exception const& err)
+    {
+      std::cerr << "error: " << err.what() << std::endl;
+      return 1;
+    }
+  } else {
+    print_usage(argv[0]);
+    return command == "-h" || command == "--help" ? 0 : 1;
+  }
+}
+
 /* EOF */
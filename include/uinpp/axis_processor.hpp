@@ -0,0 +1,136 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_AXIS_PROCESSOR_HPP
+#define HEADER_UINPP_AXIS_PROCESSOR_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "fwd.hpp"
+
+namespace uinpp {
+
+struct AxisConfig
+{
+  /** range of the raw values */
+  int in_min = -32768;
+  int in_max = 32767;
+
+  /** true for sticks, deadzone and curve are measured from the
+      center, false for triggers, where they start at in_min */
+  bool centered = true;
+
+  /** axial deadzone, as fraction of the distance from the center
+      (or from in_min) to the end of the range, 0.0 - 1.0 */
+  float deadzone = 0.0f;
+
+  /** exponent of the response curve, 1.0 is linear */
+  float curve = 1.0f;
+
+  bool invert = false;
+};
+
+/** AxisProcessor maps the raw values of a report to the abs emitters,
+    applying deadzones, response curves, inversion and the rescaling
+    to the emitter's range. Each axis is compiled into an integer
+    lookup table, so processing a report needs no float math, apart
+    from the length of radial pairs. */
+class AxisProcessor
+{
+public:
+  AxisProcessor();
+  ~AxisProcessor();
+
+  /** Add an axis that feeds \a emitter with values in
+      [out_min, out_max], returns the index of the axis in the
+      report */
+  int add_axis(EventEmitter* emitter, int out_min, int out_max, AxisConfig const& config);
+
+  /** Like above, but for the abs \a code of \a device_id, the output
+      range is the one passed to MultiDevice::add_abs(), must be
+      called before MultiDevice::finish() */
+  int add_axis(MultiDevice& uinput, uint32_t device_id, int code, AxisConfig const& config);
+
+  /** Treat \a x_axis and \a y_axis as a stick, the \a deadzone and
+      \a curve are applied to the distance from the center instead of
+      to each axis, the axial deadzones of the axes still apply */
+  void add_radial_pair(int x_axis, int y_axis, float deadzone, float curve = 1.0f);
+
+  /** Build the lookup tables, done automatically by process() after
+      the configuration changed */
+  void compile();
+
+  /** Map the raw \a values, one per axis, to the output ranges */
+  void process(std::span<int const> values, std::span<int> out);
+
+  /** process() the \a values and send them to the emitters */
+  void send(std::span<int const> values);
+
+  int get_axis_count() const { return static_cast<int>(m_configs.size()); }
+
+private:
+  struct RadialPair
+  {
+    int x_axis;
+    int y_axis;
+    float deadzone;
+    float curve;
+  };
+
+private:
+  std::vector<AxisConfig> m_configs;
+  std::vector<EventEmitter*> m_emitters;
+  std::vector<RadialPair> m_radial_pairs;
+  bool m_compiled;
+
+  /** per axis state, raw value to a signed Q15 value via m_luts
+      @{*/
+  std::vector<int64_t> m_in_min;
+  std::vector<int64_t> m_in_span;
+  std::vector<uint64_t> m_index_scale;
+  std::vector<uint32_t> m_lut_offset;
+  std::vector<uint32_t> m_lut_size;
+  std::vector<int32_t> m_luts;
+  /** @} */
+
+  /** Q15 distance from the center to a Q16 gain, RADIAL_LUT_SIZE + 2
+      entries per radial pair */
+  std::vector<int64_t> m_radial_luts;
+
+  /** Q15 to output range, out = out_min + ((v + 32767) * out_scale) >> 24
+      @{*/
+  std::vector<int64_t> m_out_min;
+  std::vector<int64_t> m_out_scale;
+  /** @} */
+
+  /** scratch for process() and send()
+      @{*/
+  std::vector<int32_t> m_values;
+  std::vector<int> m_out;
+  /** @} */
+
+private:
+  AxisProcessor(AxisProcessor const&) = delete;
+  AxisProcessor& operator=(AxisProcessor const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
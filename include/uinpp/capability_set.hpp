@@ -0,0 +1,115 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_CAPABILITY_SET_HPP
+#define HEADER_UINPP_CAPABILITY_SET_HPP
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <linux/uinput.h>
+#include <vector>
+
+namespace uinpp {
+
+/** The set of event codes a device announces to the kernel, stored as
+    packed bitsets. Absolute axes additionally carry their absinfo, as
+    two devices with the same axes but different ranges are not
+    interchangeable. */
+class CapabilitySet
+{
+public:
+  CapabilitySet();
+
+  /** Add capabilities, out of range codes throw std::out_of_range
+      @{*/
+  void add_key(uint16_t code);
+  void add_rel(uint16_t code);
+  void add_abs(uint16_t code, int min, int max, int fuzz = 0, int flat = 0, int resolution = 0);
+  void add_ff(uint16_t code);
+  void add_msc(uint16_t code);
+  void add_led(uint16_t code);
+  void add_prop(uint16_t prop);
+  /** @} */
+
+  bool has_key(uint16_t code) const { return code < KEY_CNT && m_key_bits[code]; }
+  bool has_rel(uint16_t code) const { return code < REL_CNT && m_rel_bits[code]; }
+  bool has_abs(uint16_t code) const { return code < ABS_CNT && m_abs_bits[code]; }
+  bool has_ff(uint16_t code) const { return code < FF_CNT && m_ff_bits[code]; }
+  bool has_msc(uint16_t code) const { return code < MSC_CNT && m_msc_bits[code]; }
+  bool has_led(uint16_t code) const { return code < LED_CNT && m_led_bits[code]; }
+  bool has_prop(uint16_t prop) const { return prop < INPUT_PROP_CNT && m_prop_bits[prop]; }
+
+  bool has_keys() const { return m_key_bits.any(); }
+  bool has_rels() const { return m_rel_bits.any(); }
+  bool has_abses() const { return m_abs_bits.any(); }
+  bool has_ffs() const { return m_ff_bits.any(); }
+  bool has_mscs() const { return m_msc_bits.any(); }
+  bool has_leds() const { return m_led_bits.any(); }
+
+  bool empty() const;
+
+  /** Returns the absinfo of the given axis or nullptr if the axis
+      isn't part of the set */
+  input_absinfo const* get_absinfo(uint16_t code) const;
+
+  /** Absolute axis setup, sorted by code */
+  std::vector<uinput_abs_setup> const& get_abs_setup() const { return m_abs_setup; }
+
+  std::bitset<KEY_CNT> const& get_key_bits() const { return m_key_bits; }
+  std::bitset<REL_CNT> const& get_rel_bits() const { return m_rel_bits; }
+  std::bitset<ABS_CNT> const& get_abs_bits() const { return m_abs_bits; }
+  std::bitset<FF_CNT> const& get_ff_bits() const { return m_ff_bits; }
+  std::bitset<MSC_CNT> const& get_msc_bits() const { return m_msc_bits; }
+  std::bitset<LED_CNT> const& get_led_bits() const { return m_led_bits; }
+  std::bitset<INPUT_PROP_CNT> const& get_prop_bits() const { return m_prop_bits; }
+
+  /** Adds all capabilities of \a rhs, for axes present in both the
+      absinfo of \a rhs wins */
+  CapabilitySet& operator|=(CapabilitySet const& rhs);
+
+  bool operator==(CapabilitySet const& rhs) const;
+  bool operator!=(CapabilitySet const& rhs) const { return !(*this == rhs); }
+
+  std::size_t hash() const;
+
+private:
+  std::bitset<KEY_CNT> m_key_bits;
+  std::bitset<REL_CNT> m_rel_bits;
+  std::bitset<ABS_CNT> m_abs_bits;
+  std::bitset<FF_CNT> m_ff_bits;
+  std::bitset<MSC_CNT> m_msc_bits;
+  std::bitset<LED_CNT> m_led_bits;
+  std::bitset<INPUT_PROP_CNT> m_prop_bits;
+
+  std::vector<uinput_abs_setup> m_abs_setup;
+};
+
+} // namespace uinpp
+
+template<>
+struct std::hash<uinpp::CapabilitySet>
+{
+  std::size_t operator()(uinpp::CapabilitySet const& caps) const noexcept
+  {
+    return caps.hash();
+  }
+};
+
+#endif
+
+/* EOF */
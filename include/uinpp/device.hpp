@@ -20,8 +20,14 @@
 #include <cstdint>
 #include <functional>
 #include <linux/uinput.h>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
+#include "capability_set.hpp"
+#include "device_state.hpp"
+#include "device_stats.hpp"
 #include "fwd.hpp"
 
 namespace uinpp {
@@ -31,7 +37,50 @@ enum class DeviceType
   GENERIC,
   KEYBOARD,
   MOUSE,
-  JOYSTICK
+  JOYSTICK,
+
+  /** multitouch pointer device, see Multitouch */
+  TOUCHPAD,
+
+  /** multitouch device mapped to the screen, see Multitouch */
+  TOUCHSCREEN,
+
+  /** accelerometer and gyro, the companion device of a gamepad, see
+      MotionSensor */
+  SENSOR,
+
+  /** pen tablet, see PenTablet */
+  TABLET
+};
+
+enum class DeviceBackend
+{
+  /** create a real kernel device via /dev/uinput */
+  UINPUT,
+
+  /** write the events into a socket instead, for testing and
+      benchmarking without uinput access */
+  LOOPBACK,
+
+  /** discard the events without a syscall, for measuring the
+      overhead of the library itself */
+  NONE
+};
+
+/** Result of the non-throwing send functions, ordered by severity */
+enum class SendStatus
+{
+  /** all events have been written */
+  OK,
+
+  /** the fd wasn't writable, the events are waiting in the retry queue */
+  QUEUED,
+
+  /** the retry queue was full, events have been lost */
+  DROPPED,
+
+  /** the write failed for a reason other than EAGAIN, events have been lost */
+  ERROR
 };
 
 class Device
@@ -56,52 +105,231 @@ public:
 
   void add_ff(uint16_t code);
 
+  /** Create a misc event, e.g. MSC_TIMESTAMP */
+  void add_msc(uint16_t code);
+
+  /** Create a LED the host can set, e.g. LED_CAPSL, see get_state() */
+  void add_led(uint16_t code);
+
+  /** Add all capabilities of \a caps at once */
+  void add_capabilities(CapabilitySet const& caps);
+
   void set_ff_callback(const std::function<void (uint8_t, uint8_t)>& callback);
+  std::function<void (uint8_t, uint8_t)> const& get_ff_callback() const { return m_ff_callback; }
+
+  /** Called from read() and update() when the DeviceState changed */
+  void set_state_callback(std::function<void (DeviceStateSnapshot const&)> const& callback);
+  std::function<void (DeviceStateSnapshot const&)> const& get_state_callback() const { return m_state_callback; }
+
+  /** Add the events the kernel/Xorg need to register the device as
+      its DeviceType, called automatically by finish(). Only the first
+      call has an effect, so that a finish() on another thread doesn't
+      touch the capabilities when they were applied up front. */
+  void add_mandatory_capabilities();
 
-  /** Finalized the device creation */
+  /** Select where finish() creates the device, defaults to UINPUT */
+  void set_backend(DeviceBackend backend);
+
+  /** Id under which the device shows up in the trace ring */
+  void set_trace_id(uint32_t trace_id) { m_trace_id = trace_id; }
+  uint32_t get_trace_id() const { return m_trace_id; }
+
+  /** Finalized the device creation, opens the uinput device and
+      registers all capabilities with the kernel */
   void finish();
   /*@}*/
 
-  /** Send an input event */
+  /** Send an input event, events are buffered and written to the
+      kernel as a whole frame on sync(). Throws on write errors other
+      than EAGAIN. */
   void send(uint16_t type, uint16_t code, int32_t value);
 
   /** Sends out a sync event if there is a need for it. */
   void sync();
 
+  /** Non-throwing variants of send() and sync(). When the fd isn't
+      writable the frame goes into a bounded retry queue that is
+      flushed before the next frame, on update() and on flush().
+      @{*/
+  SendStatus try_send(uint16_t type, uint16_t code, int32_t value) noexcept;
+  SendStatus try_sync() noexcept;
+  /** @} */
+
+  /** Write out the retry queue, should be called when the fd becomes
+      writable again */
+  SendStatus flush() noexcept;
+
+  /** Write a batch of complete frames, including their SYN_REPORTs,
+      with a single write(), bypassing the frame buffer and the output
+      interval. Events send before are written first.
+      @{*/
+  void send_events(std::span<input_event const> events);
+  SendStatus try_send_events(std::span<input_event const> events) noexcept;
+  /** @} */
+
+  /** Limit the output to one frame every \a msec, written by
+      update(). Until then ABS events are merged with the latest value
+      winning, REL events are summed and all other events, e.g. key
+      presses, are kept in order. 0 writes each frame on sync().
+      Multitouch devices can't be limited. */
+  void set_output_interval(int msec);
+  int get_output_interval() const { return m_output_interval; }
+
+  /** true if events are waiting in the retry queue */
+  bool has_pending() const { return !m_retry_queue.empty(); }
+
+  DeviceStats const& get_stats() const { return *m_stats; }
+
+  /** Count \a count events as dropped that never made it to the
+      device, e.g. the overflow of a lazy MultiDevice's queue */
+  void count_dropped_events(uint64_t count) noexcept;
+
+  /** LEDs, FF gain and rumble as set by the host, updated by read()
+      and update(), can be polled from any thread */
+  DeviceState const& get_state() const { return m_state; }
+
+  /** Forget the state set by the previous host, without calling the
+      state callback, e.g. when the device goes back into a DevicePool */
+  void reset_state();
+
+  /** Keep the stats in \a stats, e.g. a StatsRegion slot, instead of
+      inside the Device, the internal ones are freed meanwhile.
+      nullptr switches back to new internal stats starting at zero. */
+  void set_stats_storage(DeviceStats* stats);
+
+  /** The storage given to set_stats_storage(), nullptr if the
+      internal one is used */
+  DeviceStats* get_stats_storage() const;
+
+  /** Bytes of memory held by the Device, including its buffers */
+  std::size_t get_memory_usage() const;
+
   /** Update force feedback */
   void update(int msec_delta);
 
   /** Read incoming data (force feedback, led, etc.), non-blocking */
   void read();
 
-  /** file handle to the underlying device */
+  /** file handle to the underlying device, -1 until finish() was called */
   int get_fd() const { return m_fd; }
 
+  /** the other end of the LOOPBACK socket, the written events can be
+      read from it and events for read() written to it */
+  int get_loopback_fd() const { return m_loopback_fd; }
+
+  DeviceType get_type() const { return m_device_type; }
+  std::string const& get_name() const { return m_name; }
+  std::string const& get_phys() const { return m_phys; }
+  input_id const& get_id() const { return m_iid; }
+  bool is_finished() const { return m_finished; }
+
+  /** Kernel name of the created device, e.g. "input23", requires finish() */
+  std::string get_sysname() const;
+
+  /** sysfs directory of the created device, e.g. "/sys/devices/virtual/input/input23" */
+  std::string get_syspath() const;
+
+  /** Device nodes of the created device, e.g. "/dev/input/event17"
+      and "/dev/input/js0", empty if the kernel didn't create one */
+  std::string get_evdev_path() const;
+  std::string get_jsdev_path() const;
+
+  /** The capabilities that have been registered with the kernel so far */
+  CapabilitySet const& get_capabilities() const { return m_caps; }
+
+private:
+  void open_uinput();
+  void open_loopback();
+
+  /** returns the device node for the sysfs child entry starting with \a prefix */
+  std::string find_device_node(std::string_view prefix) const;
+
+  /** write() to the fd, or pretend to for DeviceBackend::NONE */
+  ssize_t write_bytes(void const* data, size_t len) noexcept;
+
+  /** store \a state and call the state callback if it changed */
+  void publish_state(DeviceStateSnapshot const& state);
+
+  /** write the current frame, or queue it when the fd isn't writable */
+  SendStatus write_frame() noexcept;
+
+  /** write \a events, or queue them when the fd isn't writable,
+      \a start_nsec is the time for the send_latency, 0 for none */
+  SendStatus write_buffer(input_event const* events, size_t count, uint64_t start_nsec) noexcept;
+
+  /** append to the retry queue or drop the events if it is full */
+  SendStatus queue_events(input_event const* events, size_t count) noexcept;
+
+  /** add an event to the current frame */
+  SendStatus append_event(uint16_t type, uint16_t code, int32_t value) noexcept;
+
+  /** terminate the current frame with a SYN_REPORT and write it */
+  SendStatus sync_frame() noexcept;
+
+  /** merge an event into the pending output of the rate limiter */
+  SendStatus coalesce_event(uint16_t type, uint16_t code, int32_t value) noexcept;
+
+  /** write the pending output of the rate limiter */
+  SendStatus write_pending() noexcept;
+
 private:
   DeviceType  m_device_type;
   input_id m_iid;
   std::string m_name;
+  std::string m_phys;
 
+  DeviceBackend m_backend;
   bool m_finished;
+  uint32_t m_trace_id;
 
   int m_fd;
+  int m_loopback_fd;
 
-  bool m_key_bit;
-  bool m_rel_bit;
-  bool m_abs_bit;
-  bool m_led_bit;
-  bool m_ff_bit;
-
-  bool m_abs_lst[ABS_CNT];
-  bool m_rel_lst[REL_CNT];
-  bool m_key_lst[KEY_CNT];
-  bool m_ff_lst[FF_CNT];
+  CapabilitySet m_caps;
+  bool m_mandatory_caps_added;
 
   ForceFeedbackHandler* m_ff_handler;
   std::function<void (uint8_t, uint8_t)> m_ff_callback;
 
+  DeviceState m_state;
+  std::function<void (DeviceStateSnapshot const&)> m_state_callback;
+
   bool m_needs_sync;
 
+  /** events of the current frame, not yet written */
+  std::vector<input_event> m_frame;
+
+  /** events that couldn't be written, fixed capacity */
+  std::vector<input_event> m_retry_queue;
+
+  /** bytes of the first event in m_retry_queue that were already
+      written, the LOOPBACK socket is a byte stream and can take an
+      event partially */
+  size_t m_retry_offset;
+
+  /** errno of the last failed write */
+  int m_errno;
+
+  /** steady_clock time of the first event in m_frame */
+  uint64_t m_frame_start;
+
+  /** only allocated while no external storage is set, see
+      set_stats_storage() */
+  std::unique_ptr<DeviceStats> m_own_stats;
+  DeviceStats* m_stats;
+
+  /** output rate limiter, see set_output_interval()
+      @{*/
+  int m_output_interval;
+  int m_output_elapsed;
+  bool m_output_pending;
+
+  /** the coalesced events, only allocated while the output interval
+      is set */
+  struct PendingOutput;
+  std::unique_ptr<PendingOutput> m_pending;
+  /** @} */
+
 private:
   Device (Device const&) = delete;
   Device& operator= (Device const&) = delete;
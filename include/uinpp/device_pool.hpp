@@ -0,0 +1,90 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_DEVICE_POOL_HPP
+#define HEADER_UINPP_DEVICE_POOL_HPP
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "capability_set.hpp"
+#include "device.hpp"
+
+namespace uinpp {
+
+/** Everything that makes two devices interchangeable from the point
+    of view of the kernel and its consumers */
+struct DeviceSignature
+{
+  DeviceType type;
+  std::string name;
+  std::string phys;
+  input_id id;
+  CapabilitySet caps;
+
+  bool operator==(DeviceSignature const& rhs) const;
+  bool operator!=(DeviceSignature const& rhs) const { return !(*this == rhs); }
+
+  std::size_t hash() const;
+};
+
+DeviceSignature make_device_signature(Device const& device);
+
+/** DevicePool keeps finished devices alive after their MultiDevice
+    is gone, so that a new MultiDevice with a compatible layout can
+    adopt them instead of destroying and recreating the kernel
+    devices. */
+class DevicePool
+{
+public:
+  DevicePool();
+  ~DevicePool();
+
+  /** Hand a finished device over to the pool */
+  void release(std::unique_ptr<Device> device);
+
+  /** Take a device matching \a signature out of the pool, returns
+      nullptr when there is none */
+  std::unique_ptr<Device> acquire(DeviceSignature const& signature);
+
+  /** Service force feedback requests of the pooled devices, the
+      kernel blocks the requesting process until they are answered */
+  void read();
+
+  /** Destroy all pooled devices */
+  void clear();
+
+  std::size_t size() const { return m_devices.size(); }
+
+private:
+  struct SignatureHash
+  {
+    std::size_t operator()(DeviceSignature const& signature) const { return signature.hash(); }
+  };
+
+  std::unordered_multimap<DeviceSignature, std::unique_ptr<Device>, SignatureHash> m_devices;
+
+private:
+  DevicePool(DevicePool const&) = delete;
+  DevicePool& operator=(DevicePool const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
@@ -0,0 +1,267 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_DEVICE_PROFILE_HPP
+#define HEADER_UINPP_DEVICE_PROFILE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <linux/uinput.h>
+#include <memory>
+#include <stdexcept>
+
+#include "capability_set.hpp"
+#include "device.hpp"
+
+namespace uinpp {
+
+/** A single capability of a DeviceProfile, min/max/fuzz/flat/resolution
+    are only used for EV_ABS */
+struct ProfileEntry
+{
+  uint16_t type;
+  uint16_t code;
+  int min;
+  int max;
+  int fuzz;
+  int flat;
+  int resolution;
+};
+
+/** Profile entry constructors, out of range codes fail to compile
+    @{*/
+consteval ProfileEntry profile_key(uint16_t code)
+{
+  if (code >= KEY_CNT) {
+    throw std::out_of_range("profile_key(): code out of range");
+  }
+  return { EV_KEY, code, 0, 0, 0, 0, 0 };
+}
+
+consteval ProfileEntry profile_rel(uint16_t code)
+{
+  if (code >= REL_CNT) {
+    throw std::out_of_range("profile_rel(): code out of range");
+  }
+  return { EV_REL, code, 0, 0, 0, 0, 0 };
+}
+
+consteval ProfileEntry profile_abs(uint16_t code, int min, int max, int fuzz = 0, int flat = 0, int resolution = 0)
+{
+  if (code >= ABS_CNT) {
+    throw std::out_of_range("profile_abs(): code out of range");
+  }
+  if (min > max) {
+    throw std::out_of_range("profile_abs(): min > max");
+  }
+  return { EV_ABS, code, min, max, fuzz, flat, resolution };
+}
+
+consteval ProfileEntry profile_ff(uint16_t code)
+{
+  if (code >= FF_CNT) {
+    throw std::out_of_range("profile_ff(): code out of range");
+  }
+  return { EV_FF, code, 0, 0, 0, 0, 0 };
+}
+
+consteval ProfileEntry profile_led(uint16_t code)
+{
+  if (code >= LED_CNT) {
+    throw std::out_of_range("profile_led(): code out of range");
+  }
+  return { EV_LED, code, 0, 0, 0, 0, 0 };
+}
+
+consteval ProfileEntry profile_msc(uint16_t code)
+{
+  if (code >= MSC_CNT) {
+    throw std::out_of_range("profile_msc(): code out of range");
+  }
+  return { EV_MSC, code, 0, 0, 0, 0, 0 };
+}
+/** @} */
+
+/** Compile-time description of a device: its type, default name and
+    ids, input properties and capabilities */
+template<std::size_t N>
+struct DeviceProfile
+{
+  DeviceType type;
+  char const* name;
+  input_id id;
+  uint32_t props;
+  std::array<ProfileEntry, N> entries;
+
+  constexpr bool is_valid() const
+  {
+    for (auto const& entry : entries)
+    {
+      switch (entry.type)
+      {
+        case EV_KEY:
+          if (entry.code >= KEY_CNT) { return false; }
+          break;
+
+        case EV_REL:
+          if (entry.code >= REL_CNT) { return false; }
+          break;
+
+        case EV_ABS:
+          if (entry.code >= ABS_CNT || entry.min > entry.max) { return false; }
+          break;
+
+        case EV_FF:
+          if (entry.code >= FF_CNT) { return false; }
+          break;
+
+        case EV_MSC:
+          if (entry.code >= MSC_CNT) { return false; }
+          break;
+
+        case EV_LED:
+          if (entry.code >= LED_CNT) { return false; }
+          break;
+
+        default:
+          return false;
+      }
+    }
+    return true;
+  }
+
+  CapabilitySet get_capabilities() const
+  {
+    CapabilitySet caps;
+
+    for (uint16_t prop = 0; prop < INPUT_PROP_CNT; ++prop) {
+      if (props & (1u << prop)) {
+        caps.add_prop(prop);
+      }
+    }
+
+    for (auto const& entry : entries)
+    {
+      switch (entry.type)
+      {
+        case EV_KEY: caps.add_key(entry.code); break;
+        case EV_REL: caps.add_rel(entry.code); break;
+        case EV_ABS: caps.add_abs(entry.code, entry.min, entry.max, entry.fuzz, entry.flat, entry.resolution); break;
+        case EV_FF: caps.add_ff(entry.code); break;
+        case EV_MSC: caps.add_msc(entry.code); break;
+        case EV_LED: caps.add_led(entry.code); break;
+      }
+    }
+
+    return caps;
+  }
+};
+
+template<typename... Entries>
+consteval auto make_device_profile(DeviceType type, char const* name, input_id id, uint32_t props,
+                                   Entries... entries)
+{
+  return DeviceProfile<sizeof...(Entries)>{ type, name, id, props, {{ entries... }} };
+}
+
+/** Create an unfinished Device with all capabilities of \a profile,
+    call Device::finish() to create it in the kernel */
+template<std::size_t N>
+std::unique_ptr<Device> create_device(DeviceProfile<N> const& profile)
+{
+  auto device = std::make_unique<Device>(profile.type, profile.name, profile.id);
+  device->add_capabilities(profile.get_capabilities());
+  return device;
+}
+
+/** Same as above, but overrides the name and ids of the profile */
+template<std::size_t N>
+std::unique_ptr<Device> create_device(DeviceProfile<N> const& profile,
+                                      std::string const& name, input_id const& id)
+{
+  auto device = std::make_unique<Device>(profile.type, name, id);
+  device->add_capabilities(profile.get_capabilities());
+  return device;
+}
+
+/** Xbox360 style gamepad with rumble, as presented by the xpad driver */
+inline constexpr auto xbox360_gamepad_profile = make_device_profile(
+  DeviceType::JOYSTICK, "Microsoft X-Box 360 pad",
+  input_id{ BUS_USB, 0x045e, 0x028e, 0x0110 }, 0,
+  profile_key(BTN_A), profile_key(BTN_B), profile_key(BTN_X), profile_key(BTN_Y),
+  profile_key(BTN_TL), profile_key(BTN_TR),
+  profile_key(BTN_SELECT), profile_key(BTN_START), profile_key(BTN_MODE),
+  profile_key(BTN_THUMBL), profile_key(BTN_THUMBR),
+  profile_abs(ABS_X, -32768, 32767, 16, 128),
+  profile_abs(ABS_Y, -32768, 32767, 16, 128),
+  profile_abs(ABS_RX, -32768, 32767, 16, 128),
+  profile_abs(ABS_RY, -32768, 32767, 16, 128),
+  profile_abs(ABS_Z, 0, 255),
+  profile_abs(ABS_RZ, 0, 255),
+  profile_abs(ABS_HAT0X, -1, 1),
+  profile_abs(ABS_HAT0Y, -1, 1),
+  profile_ff(FF_RUMBLE), profile_ff(FF_PERIODIC), profile_ff(FF_SQUARE),
+  profile_ff(FF_TRIANGLE), profile_ff(FF_SINE), profile_ff(FF_GAIN));
+static_assert(xbox360_gamepad_profile.is_valid());
+
+/** Five button mouse with high-resolution vertical and horizontal wheel */
+inline constexpr auto hires_mouse_profile = make_device_profile(
+  DeviceType::MOUSE, "Virtual Mouse",
+  input_id{ BUS_VIRTUAL, 0, 0, 0 }, (1u << INPUT_PROP_POINTER),
+  profile_key(BTN_LEFT), profile_key(BTN_RIGHT), profile_key(BTN_MIDDLE),
+  profile_key(BTN_SIDE), profile_key(BTN_EXTRA),
+  profile_rel(REL_X), profile_rel(REL_Y),
+  profile_rel(REL_WHEEL), profile_rel(REL_HWHEEL),
+  profile_rel(REL_WHEEL_HI_RES), profile_rel(REL_HWHEEL_HI_RES));
+static_assert(hires_mouse_profile.is_valid());
+
+/** Accelerometer and gyro, with the ranges and resolutions of the
+    DualSense motion sensors in the hid-playstation driver */
+inline constexpr auto motion_sensor_profile = make_device_profile(
+  DeviceType::SENSOR, "Virtual Motion Sensors",
+  input_id{ BUS_VIRTUAL, 0, 0, 0 }, (1u << INPUT_PROP_ACCELEROMETER),
+  profile_abs(ABS_X, -4 * 8192, 4 * 8192, 0, 0, 8192),
+  profile_abs(ABS_Y, -4 * 8192, 4 * 8192, 0, 0, 8192),
+  profile_abs(ABS_Z, -4 * 8192, 4 * 8192, 0, 0, 8192),
+  profile_abs(ABS_RX, -2048 * 1024, 2048 * 1024, 0, 0, 1024),
+  profile_abs(ABS_RY, -2048 * 1024, 2048 * 1024, 0, 0, 1024),
+  profile_abs(ABS_RZ, -2048 * 1024, 2048 * 1024, 0, 0, 1024),
+  profile_msc(MSC_TIMESTAMP));
+static_assert(motion_sensor_profile.is_valid());
+
+/** Full keyboard, all key codes from KEY_ESC to KEY_MICMUTE, and the
+    num, caps and scroll lock LEDs */
+inline constexpr auto keyboard_profile = [] {
+  constexpr size_t num_keys = KEY_MICMUTE - KEY_ESC + 1;
+  DeviceProfile<num_keys + 3> profile{
+    DeviceType::KEYBOARD, "Virtual Keyboard",
+    input_id{ BUS_VIRTUAL, 0, 0, 0 }, 0, {} };
+  for (uint16_t code = KEY_ESC; code <= KEY_MICMUTE; ++code) {
+    profile.entries[code - KEY_ESC] = ProfileEntry{ EV_KEY, code, 0, 0, 0, 0, 0 };
+  }
+  profile.entries[num_keys + 0] = profile_led(LED_NUML);
+  profile.entries[num_keys + 1] = profile_led(LED_CAPSL);
+  profile.entries[num_keys + 2] = profile_led(LED_SCROLLL);
+  return profile;
+}();
+static_assert(keyboard_profile.is_valid());
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
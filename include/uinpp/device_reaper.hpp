@@ -0,0 +1,68 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_DEVICE_REAPER_HPP
+#define HEADER_UINPP_DEVICE_REAPER_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fwd.hpp"
+
+namespace uinpp {
+
+/** DeviceReaper destroys devices on a background thread, so that the
+    UI_DEV_DESTROY and the udev work triggered by it don't stall the
+    thread that owned the device */
+class DeviceReaper
+{
+public:
+  DeviceReaper();
+
+  /** Destroys all devices that are still queued */
+  ~DeviceReaper();
+
+  /** Queue \a device for destruction, doesn't block on the kernel */
+  void dispose(std::unique_ptr<Device> device);
+
+  /** Block until all queued devices have been destroyed */
+  void wait_idle();
+
+private:
+  void run();
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::condition_variable m_idle_cond;
+  std::vector<std::unique_ptr<Device>> m_queue;
+  bool m_busy;
+  bool m_quit;
+  std::thread m_thread;
+
+private:
+  DeviceReaper(DeviceReaper const&) = delete;
+  DeviceReaper& operator=(DeviceReaper const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
@@ -0,0 +1,110 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_UINPP_DEVICE_STATE_HPP
+#define HEADER_UINPP_DEVICE_STATE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <linux/input.h>
+
+namespace uinpp {
+
+/** What the host has set on a Device */
+struct DeviceStateSnapshot
+{
+  /** bit per LED_* code */
+  uint16_t leds = 0;
+
+  /** FF_GAIN, 0 - 0xffff */
+  uint16_t ff_gain = 0xffff;
+
+  /** current rumble magnitudes with the gain applied, 0 - 0x7fff
+      @{*/
+  uint16_t strong_magnitude = 0;
+  uint16_t weak_magnitude = 0;
+  /** @} */
+
+  bool has_led(uint16_t code) const { return code < LED_CNT && (leds & (1u << code)); }
+
+  bool operator==(DeviceStateSnapshot const&) const = default;
+};
+
+/** The state is packed into a single 64bit atomic, so that a reader
+    in any thread gets a consistent snapshot of it without locks or
+    syscalls. It is only written by the thread that owns the Device. */
+class DeviceState
+{
+public:
+  static_assert(LED_CNT <= 16, "LED bits don't fit into DeviceStateSnapshot::leds");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+public:
+  DeviceState() :
+    m_state(pack(DeviceStateSnapshot{}))
+  {}
+
+  DeviceStateSnapshot load() const noexcept
+  {
+    return unpack(m_state.load(std::memory_order_acquire));
+  }
+
+  /** Returns true if \a state differs from the previous one */
+  bool store(DeviceStateSnapshot const& state) noexcept
+  {
+    uint64_t const packed = pack(state);
+    if (packed == m_state.load(std::memory_order_relaxed)) {
+      return false;
+    }
+
+    m_state.store(packed, std::memory_order_release);
+    return true;
+  }
+
+private:
+  static uint64_t pack(DeviceStateSnapshot const& state) noexcept
+  {
+    return
+      (uint64_t{state.leds} << 48) |
+      (uint64_t{state.ff_gain} << 32) |
+      (uint64_t{state.strong_magnitude} << 16) |
+      uint64_t{state.weak_magnitude};
+  }
+
+  static DeviceStateSnapshot unpack(uint64_t packed) noexcept
+  {
+    return DeviceStateSnapshot{
+      static_cast<uint16_t>(packed >> 48),
+      static_cast<uint16_t>(packed >> 32),
+      static_cast<uint16_t>(packed >> 16),
+      static_cast<uint16_t>(packed)
+    };
+  }
+
+private:
+  std::atomic<uint64_t> m_state;
+
+private:
+  DeviceState(DeviceState const&) = delete;
+  DeviceState& operator=(DeviceState const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
@@ -0,0 +1,127 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_DEVICE_STATS_HPP
+#define HEADER_UINPP_DEVICE_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace uinpp {
+
+/** Counters are only written by the thread that owns the Device, so a
+    plain load and store is enough, the atomics only make concurrent
+    readers (e.g. through a StatsRegion) safe */
+inline void stats_add(std::atomic<uint64_t>& counter, uint64_t n) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/** Histogram with power of two buckets, bucket i counts the values in
+    [2^i, 2^(i+1)) nanoseconds, bucket 0 also counts 0 */
+class LatencyHistogram
+{
+public:
+  static constexpr int BUCKETS = 40;
+
+public:
+  LatencyHistogram() :
+    m_count(0),
+    m_sum(0),
+    m_buckets()
+  {}
+
+  void record(uint64_t nsec) noexcept
+  {
+    int const bucket = nsec == 0 ? 0 : static_cast<int>(std::bit_width(nsec)) - 1;
+    stats_add(m_buckets[static_cast<size_t>(bucket < BUCKETS ? bucket : BUCKETS - 1)], 1);
+    stats_add(m_count, 1);
+    stats_add(m_sum, nsec);
+  }
+
+  uint64_t get_count() const { return m_count.load(std::memory_order_relaxed); }
+  uint64_t get_sum() const { return m_sum.load(std::memory_order_relaxed); }
+  uint64_t get_bucket(int bucket) const { return m_buckets[static_cast<size_t>(bucket)].load(std::memory_order_relaxed); }
+
+  /** Upper bound in nanoseconds of the bucket that holds the
+      \a quantile (0.0 - 1.0), 0 if nothing was recorded */
+  uint64_t get_percentile(double quantile) const;
+
+  void reset() noexcept;
+
+private:
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint64_t> m_sum;
+  std::array<std::atomic<uint64_t>, BUCKETS> m_buckets;
+
+private:
+  LatencyHistogram(LatencyHistogram const&) = delete;
+  LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+};
+
+/** Performance counters of a single Device */
+struct DeviceStats
+{
+  DeviceStats();
+
+  /** events that reached the kernel, including EV_SYN */
+  std::atomic<uint64_t> events_written;
+  std::atomic<uint64_t> bytes_written;
+
+  /** write() and read() syscalls on the device fd */
+  std::atomic<uint64_t> write_calls;
+  std::atomic<uint64_t> read_calls;
+
+  std::atomic<uint64_t> syncs;
+
+  /** frames of which events have been lost, due to a full retry
+      queue or a write error */
+  std::atomic<uint64_t> dropped_frames;
+  std::atomic<uint64_t> dropped_events;
+
+  /** events that went through the retry queue and were written later */
+  std::atomic<uint64_t> retried_events;
+
+  std::atomic<uint64_t> ff_uploads;
+  std::atomic<uint64_t> ff_erases;
+
+  /** events read back from the kernel, e.g. LED and force feedback */
+  std::atomic<uint64_t> read_events;
+
+  /** events merged into an earlier one by the output rate limiter */
+  std::atomic<uint64_t> coalesced_events;
+
+  /** time from the first event of a frame being send to it being
+      written to the kernel */
+  LatencyHistogram send_latency;
+
+  /** duration of Device::update() */
+  LatencyHistogram update_duration;
+
+  void reset() noexcept;
+
+private:
+  DeviceStats(DeviceStats const&) = delete;
+  DeviceStats& operator=(DeviceStats const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
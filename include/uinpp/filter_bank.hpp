@@ -0,0 +1,125 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_FILTER_BANK_HPP
+#define HEADER_UINPP_FILTER_BANK_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "fwd.hpp"
+
+namespace uinpp {
+
+enum class FilterType
+{
+  NONE,
+
+  /** exponential moving average with a fixed \a alpha */
+  EMA,
+
+  /** One-Euro filter, a moving average whose cutoff frequency rises
+      with the speed of the signal, smooth at rest without lagging
+      behind fast movements */
+  ONE_EURO
+};
+
+struct FilterConfig
+{
+  FilterType type = FilterType::NONE;
+
+  /** EMA: weight of the new sample, 0.0 - 1.0 */
+  float alpha = 0.5f;
+
+  /** ONE_EURO: cutoff frequency at rest in Hz, lower is smoother */
+  float min_cutoff = 1.0f;
+
+  /** ONE_EURO: increase of the cutoff per unit/sec of speed, higher
+      lags less */
+  float beta = 0.0f;
+
+  /** ONE_EURO: cutoff frequency for the speed estimate in Hz */
+  float d_cutoff = 1.0f;
+
+  /** the output only changes once the filtered value moved more than
+      this from the last output, like the kernel's fuzz */
+  float hysteresis = 0.0f;
+};
+
+/** FilterBank smooths the values of all axes of a device in one pass,
+    so that a noisy axis at rest doesn't produce an event every frame.
+    The state is kept per field in separate arrays and the filters are
+    evaluated without branches, so the loop over the axes vectorizes. */
+class FilterBank
+{
+public:
+  FilterBank();
+  ~FilterBank();
+
+  /** Add an axis feeding \a emitter, returns the index of the axis in
+      the report */
+  int add_axis(EventEmitter* emitter, FilterConfig const& config);
+
+  /** Filter the \a values, one per axis, \a dt is the time since the
+      previous report in seconds, a \a dt of zero or less is clamped
+      to a small positive step */
+  void process(std::span<int const> values, float dt, std::span<int> out);
+
+  /** process() the \a values and send the axes whose output changed
+      to their emitters */
+  void send(std::span<int const> values, float dt);
+
+  /** Forget the filter state, the next report is passed through */
+  void reset();
+
+  int get_axis_count() const { return static_cast<int>(m_emitters.size()); }
+
+private:
+  std::vector<EventEmitter*> m_emitters;
+
+  /** per axis configuration
+      @{*/
+  std::vector<float> m_ema_alpha;
+  std::vector<float> m_one_euro;
+  std::vector<float> m_min_cutoff;
+  std::vector<float> m_beta;
+  std::vector<float> m_d_cutoff;
+  std::vector<float> m_hysteresis;
+  /** @} */
+
+  /** per axis state
+      @{*/
+  std::vector<float> m_raw;
+  std::vector<float> m_value;
+  std::vector<float> m_speed;
+  std::vector<int> m_out;
+  std::vector<int> m_sent;
+  /** @} */
+
+  bool m_primed;
+  bool m_sent_valid;
+
+private:
+  FilterBank(FilterBank const&) = delete;
+  FilterBank& operator=(FilterBank const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
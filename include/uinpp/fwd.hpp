@@ -21,11 +21,15 @@
 
 namespace uinpp {
 
+class Arena;
 class ForceFeedbackHandler;
 class EventCollector;
 class EventEmitter;
 class MultiDevice;
 class Device;
+class DevicePool;
+class DeviceReaper;
+class StatsRegion;
 
 } // namespace uinpp
 
@@ -95,7 +95,10 @@ public:
       }, this);
 
     for (auto& device : m_uinput.get_devices()) {
-      m_devices.emplace_back(std::make_unique<GlibDevice>(*device));
+      // lazily created devices don't have a fd yet
+      if (device->get_fd() >= 0) {
+        m_devices.emplace_back(std::make_unique<GlibDevice>(*device));
+      }
     }
   }
 
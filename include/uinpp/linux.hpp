@@ -17,17 +17,27 @@
 #ifndef HEADER_NPP_LINUX_HPP
 #define HEADER_NPP_LINUX_HPP
 
+#include <chrono>
+#include <string>
+
 namespace uinpp {
 
 bool is_mouse_button(int ev_code);
 bool is_keyboard_button(int ev_code);
 
-/** guess the number of the next unused /dev/input/jsX device */
+/** guess the number of the next unused /dev/input/jsX device,
+    racy, prefer Device::get_jsdev_path() */
 int find_jsdev_number();
 
-/** guess the number of the next unused /dev/input/eventX device */
+/** guess the number of the next unused /dev/input/eventX device,
+    racy, prefer Device::get_evdev_path() */
 int find_evdev_number();
 
+/** Wait until the device node \a path exists and is readable by this
+    process, i.e. udev has finished setting it up. Returns false on
+    timeout. */
+bool wait_for_device_node(std::string const& path, std::chrono::milliseconds timeout);
+
 } // namespace uinpp
 
 #endif
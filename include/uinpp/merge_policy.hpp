@@ -0,0 +1,47 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_MERGE_POLICY_HPP
+#define HEADER_UINPP_MERGE_POLICY_HPP
+
+namespace uinpp {
+
+/** How a collector combines the values of multiple emitters bound to
+    the same code, see MultiDevice::set_merge_policy() */
+enum class MergePolicy
+{
+  /** the emitter that changed most recently wins, default for ABS */
+  LAST_WRITER,
+
+  /** the value furthest away from neutral wins (ABS, REL) */
+  MAX_MAGNITUDE,
+
+  /** the deflections from neutral are added up, default for REL */
+  SUM,
+
+  /** the first emitter that isn't neutral wins, in the order the
+      emitters were added (ABS, REL) */
+  PRIORITY,
+
+  /** pressed while any emitter is pressed, default for KEY */
+  OR
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
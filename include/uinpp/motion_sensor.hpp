@@ -0,0 +1,103 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_UINPP_MOTION_SENSOR_HPP
+#define HEADER_UINPP_MOTION_SENSOR_HPP
+
+#include <array>
+#include <cstdint>
+#include <linux/input.h>
+#include <span>
+#include <vector>
+
+#include "fwd.hpp"
+
+namespace uinpp {
+
+/** Ranges and resolutions default to the ones the hid-playstation
+    driver reports for the DualSense, which is what SDL and Steam
+    expect from a gamepad motion sensor */
+struct MotionSensorConfig
+{
+  /** units per g, the range is +/- accel_range g */
+  int accel_resolution = 8192;
+  int accel_range = 4;
+
+  /** units per degree/sec, the range is +/- gyro_range degree/sec */
+  int gyro_resolution = 1024;
+  int gyro_range = 2048;
+
+  /** number of samples send_batch() can take without reallocating */
+  int max_batch = 16;
+};
+
+struct ImuSample
+{
+  /** ABS_X, ABS_Y, ABS_Z in units of MotionSensorConfig::accel_resolution */
+  std::array<int, 3> accel;
+
+  /** ABS_RX, ABS_RY, ABS_RZ in units of MotionSensorConfig::gyro_resolution */
+  std::array<int, 3> gyro;
+
+  /** time the sample was taken in usec, allowed to wrap around */
+  uint32_t timestamp;
+};
+
+/** MotionSensor streams accelerometer and gyro samples to a
+    DeviceType::SENSOR device. Each sample becomes its own frame with
+    the changed axes and MSC_TIMESTAMP, a batch of samples is written
+    with a single write() instead of going through the per-event
+    path of MultiDevice::send(). */
+class MotionSensor
+{
+public:
+  /** Sets up \a device_id as DeviceType::SENSOR, must be called
+      before MultiDevice::finish() */
+  MotionSensor(MultiDevice& uinput, uint32_t device_id, MotionSensorConfig const& config);
+  ~MotionSensor();
+
+  /** Send a single sample as a complete frame, no
+      MultiDevice::sync() needed */
+  void send(ImuSample const& sample);
+
+  /** Send \a samples in order, one frame per sample, with one write() */
+  void send_batch(std::span<ImuSample const> samples);
+
+private:
+  void append(uint16_t type, uint16_t code, int value);
+
+private:
+  MultiDevice& m_uinput;
+  uint32_t m_device_id;
+
+  /** frames of the current batch */
+  std::vector<input_event> m_events;
+
+  /** the last sample send, the first one is send in full */
+  ImuSample m_last;
+  bool m_has_last;
+
+private:
+  MotionSensor(MotionSensor const&) = delete;
+  MotionSensor& operator=(MotionSensor const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
@@ -17,12 +17,18 @@
 #ifndef HEADER_NPP_MULTI_DEVICE_HPP
 #define HEADER_NPP_MULTI_DEVICE_HPP
 
+#include <chrono>
+#include <exception>
+#include <future>
 #include <map>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "fwd.hpp"
 #include "device.hpp"
 #include "event.hpp"
+#include "merge_policy.hpp"
 
 namespace uinpp {
 
@@ -45,12 +51,47 @@ private:
   uint32_t m_device_id;
 };
 
+/** Outcome of creating a single device in MultiDevice::finish_parallel() */
+struct DeviceFinishResult
+{
+  uint32_t device_id;
+
+  /** time spent in Device::finish(), i.e. UI_DEV_SETUP and UI_DEV_CREATE */
+  std::chrono::steady_clock::duration duration;
+
+  /** set when Device::finish() threw */
+  std::exception_ptr error;
+};
+
+/** Memory held by a MultiDevice, see MultiDevice::get_memory_usage() */
+struct MemoryUsage
+{
+  /** bytes of collectors, emitters and their lists in the arena */
+  std::size_t arena_bytes_used;
+
+  /** bytes the arena requested from the heap */
+  std::size_t arena_bytes_reserved;
+
+  std::size_t collector_count;
+  std::size_t emitter_count;
+
+  std::size_t device_count;
+
+  /** bytes held by the Device objects, see Device::get_memory_usage() */
+  std::size_t device_bytes;
+};
+
 /** MultiDevice bundle multiple devices to make it easier to create
     virtual devices that spread across different categories of input, e.g. a
     keyboard with a trackball would both need a mouse device as well as
     a keyboard one */
 class MultiDevice
 {
+public:
+  /** events queued per lazy device while it is being created, the
+      same as the retry queue of a Device */
+  static constexpr size_t MAX_LAZY_PENDING = 256;
+
 public:
   MultiDevice();
   ~MultiDevice();
@@ -68,8 +109,50 @@ public:
   void set_device_prop(uint32_t device_id, int prop);
   void set_device_usbid(uint32_t device_id, input_id id);
 
+  /** Create \a device_id as \a type instead of deriving the type from
+      the id, must be called before anything is added to the device */
+  void set_device_type(uint32_t device_id, DeviceType type);
+
   void set_ff_callback(int device_id, std::function<void (uint8_t, uint8_t)> const& callback);
 
+  /** See Device::set_state_callback() */
+  void set_state_callback(uint32_t device_id, std::function<void (DeviceStateSnapshot const&)> const& callback);
+
+  /** Write at most one frame every \a msec to \a device_id, see
+      Device::set_output_interval() */
+  void set_output_interval(uint32_t device_id, int msec);
+
+  /** Adopt matching devices from \a pool in finish() instead of
+      creating new ones, and hand the devices back to the pool on
+      destruction. The pool must outlive the MultiDevice. */
+  void set_device_pool(DevicePool* pool);
+
+  /** Hand the devices over to \a reaper on destruction instead of
+      destroying them synchronously. Held keys are released before the
+      handoff. The reaper must outlive the MultiDevice. */
+  void set_device_reaper(DeviceReaper* reaper);
+
+  /** Keep the DeviceStats of the devices created from now on in
+      \a region, so that they can be watched from outside the
+      process. The region must outlive the MultiDevice. */
+  void set_stats_region(StatsRegion* region);
+
+  /** Don't create the kernel devices in finish(), but when the first
+      event is send to them. Creation runs in the background, events
+      send in the meantime are queued and flushed by the next sync()
+      or update() after the device is ready. Devices that are still
+      pending are skipped by sync(), update() and get_devices(). At
+      most MAX_LAZY_PENDING events are queued per device, the rest
+      is dropped and counted in the device's DeviceStats. */
+  void set_lazy(bool lazy);
+
+  /** true while the lazy creation of \a device_id hasn't completed,
+      false once the device is ready or its creation failed */
+  bool is_device_pending(uint32_t device_id) const;
+
+  /** Backend for the devices created from now on */
+  void set_backend(DeviceBackend backend);
+
   VirtualDevice* create_device(int slot, DeviceType type);
 
   EventEmitter* add(Event const& ev);
@@ -77,25 +160,79 @@ public:
   EventEmitter* add_abs(uint32_t device_id, int ev_code, int min, int max, int fuzz, int flat, int resolution);
   EventEmitter* add_key(uint32_t device_id, int ev_code);
 
+  /** Returns the absinfo of \a ev_code or nullptr if the axis wasn't
+      added to \a device_id */
+  input_absinfo const* get_absinfo(uint32_t device_id, int ev_code) const;
+
   void add_ff(uint32_t device_id, uint16_t code);
+  void add_led(uint32_t device_id, uint16_t code);
+
+  /** Add capabilities without creating emitters, for events that are
+      send directly via send() */
+  void add_capabilities(uint32_t device_id, CapabilitySet const& caps);
+
+  /** Select how the emitters bound to the same code are combined,
+      must be called after the code was added. ABS and REL values are
+      merged once per sync() and only send when changed, keys are
+      send right away to keep their edges. \a neutral is the value of
+      an idle ABS emitter, clamped to the axis range. */
+  void set_merge_policy(uint32_t device_id, int ev_type, int ev_code, MergePolicy policy, int neutral = 0);
 
   /** needs to be called to finish device creation and create the
       device in the kernel */
   void finish();
+
+  /** Like finish(), but creates the devices concurrently on up to
+      \a num_threads threads. Errors don't abort the other devices,
+      they are reported per device in the result. Devices adopted
+      from the device pool are not listed. */
+  std::vector<DeviceFinishResult> finish_parallel(unsigned int num_threads = 4);
   /** @} */
 
   /** Send events directly to the kernel
       @{*/
   void send(uint32_t device_id, int ev_type, int ev_code, int value);
+
+  /** Move \a code by \a value every \a repeat_interval msec, driven
+      by update(). The movement is accumulated exactly and send as at
+      most one event per code and update(), independent of the tick
+      rate. A negative \a repeat_interval stops the repeat. */
   void send_rel_repetitive(Event const& code, float value, int repeat_interval);
 
+  /** Scroll \a code (REL_WHEEL or REL_HWHEEL) by \a value in 1/120 of
+      a notch. The legacy notches are derived from the accumulated
+      value, the hi-res events are only send when the device has
+      REL_WHEEL_HI_RES/REL_HWHEEL_HI_RES. */
+  void send_scroll(uint32_t device_id, int code, int value);
+
+  /** Scroll \a code (REL_WHEEL or REL_HWHEEL) continuously at
+      \a notches_per_sec, driven by update(), 0 stops scrolling */
+  void set_scroll_velocity(uint32_t device_id, int code, float notches_per_sec);
+
   /** should be called to signal that all events of the current frame
       have been send */
   void sync();
+
+  /** Non-throwing variants of send() and sync(), see Device::try_send()
+      @{*/
+  SendStatus try_send(uint32_t device_id, int ev_type, int ev_code, int value) noexcept;
+  SendStatus try_sync() noexcept;
   /** @} */
 
+  /** Write a batch of complete frames to \a device_id with a single
+      write(), see Device::send_events() */
+  void send_events(uint32_t device_id, std::span<input_event const> events);
+
+  /** Write out the retry queues of all devices */
+  SendStatus flush() noexcept;
+  /** @} */
+
+  /** The created devices, without the lazy ones that are still
+      pending or whose creation failed */
   std::vector<Device*> get_devices() const;
 
+  MemoryUsage get_memory_usage() const;
+
   void update(int msec_delta);
 
 private:
@@ -111,14 +248,81 @@ private:
 
   EventEmitter* create_emitter(int device_id, int type, int code);
 
+  /** send() without the hi-res wheel mirroring */
+  void send_event(uint32_t device_id, int ev_type, int ev_code, int value);
+
+  /** the hi-res code REL_WHEEL/REL_HWHEEL events need to be mirrored
+      to, or -1 if the device has no hi-res wheel or the user drives
+      it with its own emitter */
+  int get_hires_mirror(uint32_t device_id, int ev_code) const;
+
+  /** fill m_hires_mirrors, called by finish() once the capabilities
+      and collectors are final */
+  void update_hires_mirrors();
+
+  /** replace \a device with a matching one from the device pool,
+      returns false if there is none */
+  bool adopt_pooled_device(std::unique_ptr<Device>& device);
+
+  /** queue an event for a device that isn't created yet, starting
+      the creation if needed */
+  void send_lazy(uint32_t device_id, int ev_type, int ev_code, int value);
+
+  /** flush the queued events of lazily created devices that became ready */
+  void poll_lazy_devices();
+
+  /** remember the frame boundary for the flush of a lazy device */
+  void sync_lazy_device(uint32_t device_id);
+
 private:
+  /** velocity of a rel repeat, kept as the exact fraction
+      value / repeat_interval */
   struct RelRepeat
   {
-    Event code;
-    float value;
-    float rest;
-    int time_count;
-    int repeat_interval;
+    uint32_t device_id;
+    int code;
+
+    /** value in 1/65536 units */
+    int64_t value;
+    int64_t repeat_interval;
+
+    /** movement not send yet, in 1/65536 units * repeat_interval */
+    int64_t remainder;
+  };
+
+  struct Scroll
+  {
+    uint32_t device_id;
+
+    /** REL_WHEEL or REL_HWHEEL */
+    int code;
+
+    /** hi-res units per second, in 1/65536 */
+    int64_t velocity;
+
+    /** hi-res movement not send yet, in 1/65536 units * 1000 */
+    int64_t remainder;
+
+    /** hi-res units not yet send as legacy notch */
+    int legacy_remainder;
+  };
+
+  /** the hi-res wheels of a device REL_WHEEL/REL_HWHEEL get mirrored to */
+  struct HiresMirror
+  {
+    bool wheel;
+    bool hwheel;
+  };
+
+  struct LazyDevice
+  {
+    std::future<void> creation;
+    std::vector<input_event> pending;
+
+    /** events that didn't fit into pending */
+    uint64_t dropped;
+
+    bool failed;
   };
 
 private:
@@ -128,11 +332,31 @@ private:
   std::map<uint32_t, struct input_id> m_device_usbids;
   std::map<uint32_t, std::string> m_device_phys;
   std::map<uint32_t, int> m_device_prop;
-  std::vector<std::unique_ptr<EventCollector>> m_collectors;
+  std::map<uint32_t, DeviceType> m_device_types;
+
+  /** collectors and their emitters, allocated next to each other so
+      that dispatching an emitter touches few cache lines */
+  std::unique_ptr<Arena> m_arena;
 
-  std::map<Event, RelRepeat> m_rel_repeat_lst;
+  /** owned, destroyed in ~MultiDevice(), the memory belongs to m_arena */
+  std::vector<EventCollector*> m_collectors;
+
+  std::vector<RelRepeat> m_rel_repeats;
+  std::vector<Scroll> m_scrolls;
+
+  /** only devices that mirror at least one wheel, see get_hires_mirror() */
+  std::map<uint32_t, HiresMirror> m_hires_mirrors;
 
   bool m_extra_events;
+  bool m_lazy;
+  DeviceBackend m_backend;
+
+  /** devices of a lazy MultiDevice that are not yet created */
+  std::map<uint32_t, LazyDevice> m_lazy_devices;
+
+  DevicePool* m_device_pool;
+  DeviceReaper* m_device_reaper;
+  StatsRegion* m_stats_region;
 
 private:
   MultiDevice(MultiDevice const&);
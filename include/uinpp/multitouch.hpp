@@ -0,0 +1,128 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_MULTITOUCH_HPP
+#define HEADER_UINPP_MULTITOUCH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "device.hpp"
+#include "fwd.hpp"
+
+namespace uinpp {
+
+struct MultitouchConfig
+{
+  /** number of contacts that can be tracked at once */
+  int num_slots = 5;
+
+  int x_min = 0;
+  int x_max = 1919;
+  int y_min = 0;
+  int y_max = 941;
+
+  /** units per mm, libinput needs it to size touchpads */
+  int resolution = 0;
+
+  /** 0 for devices without pressure */
+  int pressure_max = 0;
+};
+
+/** Multitouch turns the contact state of a touchpad or touchscreen
+    into type B multitouch events. The contacts are set per slot and
+    send() only emits what changed since the previous frame, along
+    with the single touch emulation (BTN_TOUCH, ABS_X/ABS_Y and for
+    touchpads BTN_TOOL_FINGER and friends). */
+class Multitouch
+{
+public:
+  /** Sets up \a device_id as \a type, which must be
+      DeviceType::TOUCHPAD or DeviceType::TOUCHSCREEN, must be called
+      before MultiDevice::finish() */
+  Multitouch(MultiDevice& uinput, uint32_t device_id, DeviceType type, MultitouchConfig const& config);
+  ~Multitouch();
+
+  /** Place a contact in \a slot, or move the contact already there */
+  void set_contact(int slot, int x, int y, int pressure = 0);
+
+  /** Lift the contact in \a slot, a set_contact() on the same slot
+      before the next send() starts a new contact */
+  void release_contact(int slot);
+
+  /** Lift all contacts */
+  void release_all();
+
+  /** Send the changes since the previous send(), needs to be
+      followed by MultiDevice::sync() */
+  void send();
+
+  int get_num_slots() const { return m_num_slots; }
+
+private:
+  void select_slot(int slot);
+
+private:
+  MultiDevice& m_uinput;
+  uint32_t m_device_id;
+  DeviceType m_type;
+  int m_num_slots;
+  bool m_has_pressure;
+
+  /** contacts as set by the user, per slot
+      @{*/
+  std::vector<uint8_t> m_active;
+  std::vector<uint8_t> m_lifted;
+  std::vector<int> m_x;
+  std::vector<int> m_y;
+  std::vector<int> m_pressure;
+  /** @} */
+
+  /** contacts as last send to the device, per slot
+      @{*/
+  std::vector<uint8_t> m_sent_active;
+  std::vector<int> m_sent_x;
+  std::vector<int> m_sent_y;
+  std::vector<int> m_sent_pressure;
+
+  /** order in which the contacts started, the oldest one drives the
+      single touch emulation */
+  std::vector<uint64_t> m_sent_serial;
+  /** @} */
+
+  int m_current_slot;
+  int m_next_tracking_id;
+  uint64_t m_next_serial;
+
+  /** single touch state as last send to the device
+      @{*/
+  bool m_touch;
+  int m_tool;
+  int m_st_x;
+  int m_st_y;
+  int m_st_pressure;
+  /** @} */
+
+private:
+  Multitouch(Multitouch const&) = delete;
+  Multitouch& operator=(Multitouch const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <linux/input.h>
 #include <string>
+#include <vector>
 
 namespace uinpp {
 
@@ -52,6 +53,10 @@ void split_event_name(std::string const& str, std::string* event_str, int* slot_
 uint16_t str2deviceid(std::string const& device);
 uint16_t str2slotid(std::string const& slot);
 
+/** in: "1,4,16"
+    out: { 1, 4, 16 } */
+std::vector<int> parse_int_list(std::string const& str);
+
 } // namespace uinpp
 
 #endif
@@ -0,0 +1,151 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_UINPP_PEN_TABLET_HPP
+#define HEADER_UINPP_PEN_TABLET_HPP
+
+#include <cstdint>
+#include <linux/input.h>
+#include <span>
+#include <vector>
+
+#include "fwd.hpp"
+
+namespace uinpp {
+
+struct PenTabletConfig
+{
+  int x_max = 32767;
+  int y_max = 18431;
+
+  /** units per mm, libinput needs it to map the tablet */
+  int resolution = 100;
+
+  /** 0 for a pen without pressure */
+  int pressure_max = 4095;
+
+  /** tilt in degree, the range is +/- tilt_max, 0 for a pen without
+      tilt */
+  int tilt_max = 64;
+
+  /** true for a screen tablet, false for an opaque one */
+  bool direct = true;
+
+  /** register BTN_TOOL_RUBBER for PenTool::ERASER */
+  bool has_eraser = false;
+};
+
+enum class PenTool
+{
+  PEN,
+  ERASER
+};
+
+/** bits of PenSample::buttons */
+enum PenButton : uint8_t
+{
+  PEN_BUTTON_STYLUS = 1 << 0,
+  PEN_BUTTON_STYLUS2 = 1 << 1
+};
+
+struct PenSample
+{
+  /** the pen is in range of the tablet, the other fields are ignored
+      when it isn't */
+  bool proximity;
+
+  PenTool tool;
+
+  int x;
+  int y;
+
+  /** the tip touches the tablet when the pressure is above 0 */
+  int pressure;
+
+  int tilt_x;
+  int tilt_y;
+
+  /** PenButton bits */
+  uint8_t buttons;
+};
+
+/** PenTablet turns whole pen samples into tablet events. Only the
+    fields that changed since the previous sample are send, and the
+    proximity changes are sequenced the way libinput expects them: the
+    tool comes into proximity along with its position, and the tip and
+    buttons are released in a frame of their own before the tool
+    leaves proximity. */
+class PenTablet
+{
+public:
+  /** Sets up \a device_id as DeviceType::TABLET, must be called
+      before MultiDevice::finish() */
+  PenTablet(MultiDevice& uinput, uint32_t device_id, PenTabletConfig const& config);
+  ~PenTablet();
+
+  /** Send the changes of \a sample as complete frames, no
+      MultiDevice::sync() needed */
+  void send(PenSample const& sample);
+
+  /** Send \a samples in order with one write() */
+  void send_batch(std::span<PenSample const> samples);
+
+private:
+  void append_sample(PenSample const& sample);
+
+  /** release the tip and the buttons, then take the tool out of
+      proximity */
+  void append_leave();
+
+  void append_abs(uint16_t code, int value, int& sent);
+  void append_key(uint16_t code, bool value, bool& sent);
+  void append(uint16_t type, uint16_t code, int value);
+
+private:
+  MultiDevice& m_uinput;
+  uint32_t m_device_id;
+  bool m_has_pressure;
+  bool m_has_tilt;
+  bool m_has_eraser;
+
+  /** frames of the current batch */
+  std::vector<input_event> m_events;
+
+  /** state as last send to the device
+      @{*/
+  bool m_proximity;
+  PenTool m_tool;
+  int m_x;
+  int m_y;
+  int m_pressure;
+  int m_tilt_x;
+  int m_tilt_y;
+  bool m_touch;
+  bool m_stylus;
+  bool m_stylus2;
+  /** @} */
+
+private:
+  PenTablet(PenTablet const&) = delete;
+  PenTablet& operator=(PenTablet const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
@@ -0,0 +1,101 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_STATS_REGION_HPP
+#define HEADER_UINPP_STATS_REGION_HPP
+
+#include <array>
+#include <atomic>
+#include <linux/uinput.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+#include "device_stats.hpp"
+
+namespace uinpp {
+
+/** Shared memory page holding the DeviceStats of a process, so that
+    external tools (see 'uinpp-util stats') can watch the counters
+    of a running process without stopping it */
+class StatsRegion
+{
+public:
+  static constexpr uint32_t MAGIC = 0x706e6975; // "uinp"
+  static constexpr uint32_t VERSION = 2;
+  static constexpr int MAX_DEVICES = 32;
+
+  struct Slot
+  {
+    /** 0 when free, 1 when in use, 2 while acquire() is filling in
+        a claimed slot; readers must only look at slots that are 1 */
+    std::atomic<uint32_t> in_use;
+    uint32_t device_id;
+    char name[UINPUT_MAX_NAME_SIZE];
+    DeviceStats stats;
+  };
+
+  struct Layout
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    pid_t pid;
+    std::array<Slot, MAX_DEVICES> slots;
+  };
+
+public:
+  /** "/uinpp-<pid>" */
+  static std::string get_default_name(pid_t pid);
+
+  /** Create the region as /dev/shm/\a name, it is removed again on
+      destruction */
+  static std::unique_ptr<StatsRegion> create(std::string const& name);
+
+  /** Map an existing region read-only */
+  static std::unique_ptr<StatsRegion> open(std::string const& name);
+
+public:
+  ~StatsRegion();
+
+  /** Take a free slot, returns nullptr when all are in use */
+  DeviceStats* acquire(uint32_t device_id, std::string_view name);
+
+  /** Give back a slot returned by acquire() */
+  void release(DeviceStats* stats);
+
+  Layout const& get_layout() const { return *m_layout; }
+  std::string const& get_name() const { return m_name; }
+
+private:
+  StatsRegion(std::string const& name, Layout* layout, bool owner);
+
+private:
+  std::string m_name;
+  Layout* m_layout;
+  bool m_owner;
+
+private:
+  StatsRegion(StatsRegion const&) = delete;
+  StatsRegion& operator=(StatsRegion const&) = delete;
+};
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
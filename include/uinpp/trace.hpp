@@ -0,0 +1,134 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_TRACE_HPP
+#define HEADER_UINPP_TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace uinpp {
+
+/** Where in the event path a TraceRecord was taken */
+enum class TracePhase : uint8_t
+{
+  /** event added to the frame, Device::try_send() */
+  SEND,
+
+  /** frame terminated, Device::try_sync() */
+  SYNC,
+
+  /** frame written to the fd, value is the number of bytes or -errno */
+  WRITE,
+
+  /** events from the retry queue written, value as for WRITE */
+  FLUSH,
+
+  /** event read back from the fd, Device::read() */
+  READ,
+
+  /** MultiDevice::update(), value is the msec delta */
+  UPDATE
+};
+
+char const* to_string(TracePhase phase);
+
+struct TraceRecord
+{
+  /** steady_clock time in nanoseconds */
+  uint64_t timestamp;
+
+  /** MultiDevice device_id, see Device::set_trace_id() */
+  uint32_t device;
+
+  TracePhase phase;
+  uint16_t type;
+  uint16_t code;
+  int32_t value;
+};
+
+/** Fixed size ring of binary trace records. Recording is lock-free,
+    wait-free and never allocates, so it can stay enabled in
+    production. Old records are overwritten once the ring is full. */
+class TraceRing
+{
+public:
+  static constexpr std::size_t CAPACITY = 4096;
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+  TraceRing();
+
+  void enable(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+  bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  /** Add a record, safe to call from any thread */
+  void record(uint32_t device, TracePhase phase,
+              uint16_t type, uint16_t code, int32_t value) noexcept;
+
+  /** Returns the records currently in the ring, oldest first. Records
+      that are overwritten while reading are skipped. */
+  std::vector<TraceRecord> snapshot() const;
+
+  /** Write the snapshot() as text, one record per line */
+  void dump(std::ostream& out) const;
+
+  /** Forget all records recorded so far */
+  void clear();
+
+private:
+  /** seqlock protected slot, fields are packed into atomic words so
+      that concurrent readers never see torn values */
+  struct Slot
+  {
+    /** 2 * index + 1 while being written, 2 * index + 2 when complete */
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> timestamp;
+    std::atomic<uint64_t> device_phase;
+    std::atomic<uint64_t> event;
+  };
+
+  std::atomic<bool> m_enabled;
+  std::atomic<uint64_t> m_head;
+  std::atomic<uint64_t> m_tail;
+  std::array<Slot, CAPACITY> m_slots;
+
+private:
+  TraceRing(TraceRing const&) = delete;
+  TraceRing& operator=(TraceRing const&) = delete;
+};
+
+/** The process wide trace ring used by Device and MultiDevice */
+TraceRing& get_trace_ring();
+
+/** Record into the global ring, a single relaxed load when disabled */
+inline void trace(uint32_t device, TracePhase phase,
+                  uint16_t type, uint16_t code, int32_t value) noexcept
+{
+  TraceRing& ring = get_trace_ring();
+  if (ring.is_enabled()) {
+    ring.record(device, phase, type, code, value);
+  }
+}
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
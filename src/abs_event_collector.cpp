@@ -16,32 +16,118 @@
 
 #include "abs_event_collector.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
 #include "multi_device.hpp"
 
 namespace uinpp {
 
-AbsEventCollector::AbsEventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code) :
-  EventCollector(uinput, device_id, type, code),
-  m_emitters()
+AbsEventCollector::AbsEventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code) :
+  EventCollector(uinput, arena, device_id, type, code, MergePolicy::LAST_WRITER),
+  m_emitters(&arena),
+  m_min(std::numeric_limits<int>::min()),
+  m_max(std::numeric_limits<int>::max()),
+  m_last_writer(nullptr),
+  m_dirty(false),
+  m_value(0),
+  m_has_value(false)
 {
+  if (input_absinfo const* absinfo = uinput.get_absinfo(device_id, code)) {
+    m_min = absinfo->minimum;
+    m_max = absinfo->maximum;
+  }
 }
 
 EventEmitter*
 AbsEventCollector::create_emitter()
 {
-  m_emitters.emplace_back(std::make_unique<AbsEventEmitter>(*this));
+  m_emitters.emplace_back(m_arena.create<AbsEventEmitter>(*this));
   return m_emitters.back().get();
 }
 
 void
-AbsEventCollector::send(int value)
+AbsEventCollector::send(AbsEventEmitter const& emitter)
 {
-  m_uinput.send(get_device_id(), get_type(), get_code(), value);
+  m_last_writer = &emitter;
+  m_dirty = true;
+}
+
+int
+AbsEventCollector::merge() const
+{
+  int const neutral = std::clamp(m_neutral, std::min(m_min, m_max), std::max(m_min, m_max));
+
+  switch (m_merge_policy)
+  {
+    case MergePolicy::MAX_MAGNITUDE:
+      {
+        int value = neutral;
+        int64_t magnitude = -1;
+        for (auto const& emitter : m_emitters)
+        {
+          int64_t const m = std::abs(int64_t{emitter->get_value()} - neutral);
+          if (m > magnitude) {
+            magnitude = m;
+            value = emitter->get_value();
+          }
+        }
+        return value;
+      }
+
+    case MergePolicy::SUM:
+      {
+        int64_t value = neutral;
+        for (auto const& emitter : m_emitters) {
+          value += int64_t{emitter->get_value()} - neutral;
+        }
+        return static_cast<int>(std::clamp(value, int64_t{m_min}, int64_t{m_max}));
+      }
+
+    case MergePolicy::PRIORITY:
+      for (auto const& emitter : m_emitters)
+      {
+        if (emitter->get_value() != neutral) {
+          return emitter->get_value();
+        }
+      }
+      return neutral;
+
+    case MergePolicy::LAST_WRITER:
+    default:
+      return m_last_writer->get_value();
+  }
 }
 
 void
 AbsEventCollector::sync()
 {
+  if (!m_dirty) {
+    return;
+  }
+
+  m_dirty = false;
+
+  int const value = merge();
+  if (!m_has_value || value != m_value)
+  {
+    m_value = value;
+    m_has_value = true;
+    m_uinput.send(get_device_id(), get_type(), get_code(), value);
+  }
+}
+
+void
+AbsEventCollector::reset()
+{
+  m_dirty = false;
+}
+
+bool
+AbsEventCollector::supports_merge_policy(MergePolicy policy) const
+{
+  return policy != MergePolicy::OR;
 }
 
 } // namespace uinpp
@@ -26,15 +26,35 @@ namespace uinpp {
 class AbsEventCollector : public EventCollector
 {
 public:
-  AbsEventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code);
+  AbsEventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code);
 
   EventEmitter* create_emitter() override;
+  std::size_t get_emitter_count() const override { return m_emitters.size(); }
   void sync() override;
+  void reset() override;
 
-  void send(int value);
+  /** \a emitter changed its value, merged on the next sync() */
+  void send(AbsEventEmitter const& emitter);
+
+protected:
+  bool supports_merge_policy(MergePolicy policy) const override;
+
+private:
+  int merge() const;
 
 private:
-  std::vector<std::unique_ptr<AbsEventEmitter>> m_emitters;
+  std::pmr::vector<ArenaPtr<AbsEventEmitter>> m_emitters;
+
+  /** range of the axis, for clamping SUM */
+  int m_min;
+  int m_max;
+
+  AbsEventEmitter const* m_last_writer;
+  bool m_dirty;
+
+  /** the value last send to the device */
+  int m_value;
+  bool m_has_value;
 
 private:
   AbsEventCollector(AbsEventCollector const&);
@@ -32,7 +32,7 @@ AbsEventEmitter::send(int value)
   if (m_value != value)
   {
     m_value = value;
-    m_collector.send(m_value);
+    m_collector.send(*this);
   }
 }
 
@@ -32,6 +32,8 @@ public:
 
   void send(int value) override;
 
+  int get_value() const { return m_value; }
+
 private:
   AbsEventCollector& m_collector;
   int m_value;
@@ -0,0 +1,115 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_ARENA_HPP
+#define HEADER_UINPP_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace uinpp {
+
+/** Monotonic memory resource that keeps objects allocated after each
+    other next to each other in memory. Memory is only released when
+    the Arena is destroyed. */
+class Arena : public std::pmr::memory_resource
+{
+public:
+  Arena(std::size_t initial_size = 4096) :
+    m_upstream(),
+    m_resource(initial_size, &m_upstream),
+    m_bytes_used(0)
+  {}
+
+  /** Construct a T in the arena, must be destroyed with ArenaDeleter */
+  template<typename T, typename... Args>
+  T* create(Args&&... args)
+  {
+    void* ptr = allocate(sizeof(T), alignof(T));
+    return new (ptr) T(std::forward<Args>(args)...);
+  }
+
+  /** bytes handed out to objects */
+  std::size_t get_bytes_used() const { return m_bytes_used; }
+
+  /** bytes requested from the system */
+  std::size_t get_bytes_reserved() const { return m_upstream.bytes; }
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    m_bytes_used += bytes;
+    return m_resource.allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) override
+  {
+    // monotonic, released all at once on destruction
+  }
+
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+  /** counts the buffers the monotonic resource requests */
+  struct Upstream : public std::pmr::memory_resource
+  {
+    std::size_t bytes = 0;
+
+    void* do_allocate(std::size_t size, std::size_t alignment) override
+    {
+      bytes += size;
+      return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+
+    void do_deallocate(void* ptr, std::size_t size, std::size_t alignment) override
+    {
+      std::pmr::new_delete_resource()->deallocate(ptr, size, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override
+    {
+      return this == &other;
+    }
+  };
+
+  Upstream m_upstream;
+  std::pmr::monotonic_buffer_resource m_resource;
+  std::size_t m_bytes_used;
+
+private:
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+};
+
+/** Runs the destructor only, the memory belongs to the Arena */
+struct ArenaDeleter
+{
+  template<typename T>
+  void operator()(T* ptr) const { std::destroy_at(ptr); }
+};
+
+template<typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+} // namespace uinpp
+
+#endif
+
+/* EOF */
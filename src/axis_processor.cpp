@@ -0,0 +1,285 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "axis_processor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "event_emitter.hpp"
+#include "multi_device.hpp"
+
+namespace uinpp {
+
+namespace {
+
+/** axes with a larger range are interpolated */
+constexpr int64_t MAX_LUT_SIZE = 1024;
+
+constexpr int RADIAL_LUT_SIZE = 1024;
+
+/** largest distance from the center in Q15, sqrt(2) * 32767 */
+constexpr int64_t RADIAL_MAX = 46341;
+
+constexpr int64_t Q15_MAX = 32767;
+
+/** Apply the deadzone and the response curve to \a x in [0, 1] */
+double apply_response(double x, double deadzone, double curve)
+{
+  if (x <= deadzone) {
+    return 0.0;
+  }
+
+  x = (x - deadzone) / (1.0 - deadzone);
+  return std::pow(x, curve);
+}
+
+} // namespace
+
+AxisProcessor::AxisProcessor() :
+  m_configs(),
+  m_emitters(),
+  m_radial_pairs(),
+  m_compiled(false),
+  m_in_min(),
+  m_in_span(),
+  m_index_scale(),
+  m_lut_offset(),
+  m_lut_size(),
+  m_luts(),
+  m_radial_luts(),
+  m_out_min(),
+  m_out_scale(),
+  m_values(),
+  m_out()
+{
+}
+
+AxisProcessor::~AxisProcessor()
+{
+}
+
+int
+AxisProcessor::add_axis(EventEmitter* emitter, int out_min, int out_max, AxisConfig const& config)
+{
+  if (config.in_min >= config.in_max) {
+    throw std::runtime_error(fmt::format("AxisProcessor: invalid input range [{}, {}]",
+                                         config.in_min, config.in_max));
+  }
+
+  if (config.deadzone < 0.0f || config.deadzone >= 1.0f || config.curve <= 0.0f) {
+    throw std::runtime_error(fmt::format("AxisProcessor: invalid deadzone {} or curve {}",
+                                         config.deadzone, config.curve));
+  }
+
+  m_configs.emplace_back(config);
+  m_emitters.emplace_back(emitter);
+  m_out_min.emplace_back(out_min);
+  m_out_scale.emplace_back((static_cast<int64_t>(out_max - out_min) << 24) / (2 * Q15_MAX));
+  m_compiled = false;
+
+  return static_cast<int>(m_configs.size()) - 1;
+}
+
+int
+AxisProcessor::add_axis(MultiDevice& uinput, uint32_t device_id, int code, AxisConfig const& config)
+{
+  input_absinfo const* absinfo_ptr = uinput.get_absinfo(device_id, code);
+  if (absinfo_ptr == nullptr) {
+    throw std::runtime_error(fmt::format("AxisProcessor: abs axis {} wasn't added to device {}",
+                                         code, device_id));
+  }
+
+  input_absinfo const absinfo = *absinfo_ptr;
+  EventEmitter* emitter = uinput.add_abs(device_id, code,
+                                         absinfo.minimum, absinfo.maximum,
+                                         absinfo.fuzz, absinfo.flat, absinfo.resolution);
+  return add_axis(emitter, absinfo.minimum, absinfo.maximum, config);
+}
+
+void
+AxisProcessor::add_radial_pair(int x_axis, int y_axis, float deadzone, float curve)
+{
+  int const count = get_axis_count();
+  if (x_axis < 0 || x_axis >= count || y_axis < 0 || y_axis >= count || x_axis == y_axis) {
+    throw std::runtime_error(fmt::format("AxisProcessor: invalid radial pair ({}, {})", x_axis, y_axis));
+  }
+
+  if (!m_configs[x_axis].centered || !m_configs[y_axis].centered) {
+    throw std::runtime_error(fmt::format("AxisProcessor: radial pair ({}, {}) needs centered axes",
+                                         x_axis, y_axis));
+  }
+
+  if (deadzone < 0.0f || deadzone >= 1.0f || curve <= 0.0f) {
+    throw std::runtime_error(fmt::format("AxisProcessor: invalid deadzone {} or curve {}", deadzone, curve));
+  }
+
+  m_radial_pairs.emplace_back(RadialPair{x_axis, y_axis, deadzone, curve});
+  m_compiled = false;
+}
+
+void
+AxisProcessor::compile()
+{
+  size_t const count = m_configs.size();
+
+  std::vector<bool> paired(count, false);
+  for (RadialPair const& pair : m_radial_pairs) {
+    paired[pair.x_axis] = true;
+    paired[pair.y_axis] = true;
+  }
+
+  m_in_min.resize(count);
+  m_in_span.resize(count);
+  m_index_scale.resize(count);
+  m_lut_offset.resize(count);
+  m_lut_size.resize(count);
+  m_luts.clear();
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    AxisConfig const& config = m_configs[i];
+
+    int64_t const span = int64_t{config.in_max} - config.in_min;
+    int64_t const size = std::min(span, MAX_LUT_SIZE);
+
+    m_in_min[i] = config.in_min;
+    m_in_span[i] = span;
+    // Q32, exactly 1 when every raw value has its own entry
+    m_index_scale[i] = ((static_cast<uint64_t>(size) << 32) + static_cast<uint64_t>(span / 2)) /
+      static_cast<uint64_t>(span);
+    m_lut_offset[i] = static_cast<uint32_t>(m_luts.size());
+    m_lut_size[i] = static_cast<uint32_t>(size);
+
+    // the curve of paired axes is applied to the radius
+    double const curve = paired[i] ? 1.0 : config.curve;
+
+    for (int64_t j = 0; j <= size; ++j)
+    {
+      double const raw = static_cast<double>(j) * static_cast<double>(span) / static_cast<double>(size);
+
+      double value;
+      if (config.centered)
+      {
+        double x = raw / static_cast<double>(span) * 2.0 - 1.0;
+        if (config.invert) {
+          x = -x;
+        }
+        value = std::copysign(apply_response(std::abs(x), config.deadzone, curve), x);
+      }
+      else
+      {
+        double x = raw / static_cast<double>(span);
+        if (config.invert) {
+          x = 1.0 - x;
+        }
+        value = apply_response(x, config.deadzone, curve) * 2.0 - 1.0;
+      }
+
+      m_luts.emplace_back(static_cast<int32_t>(std::lround(value * Q15_MAX)));
+    }
+
+    // padding, so that interpolating the last entry stays in bounds
+    m_luts.emplace_back(m_luts.back());
+  }
+
+  m_radial_luts.clear();
+  for (RadialPair const& pair : m_radial_pairs)
+  {
+    for (int j = 0; j <= RADIAL_LUT_SIZE; ++j)
+    {
+      double const r = static_cast<double>(j) * RADIAL_MAX / RADIAL_LUT_SIZE / Q15_MAX;
+      double gain = 0.0;
+      if (j != 0) {
+        gain = apply_response(r, pair.deadzone, pair.curve) / r;
+      }
+      m_radial_luts.emplace_back(std::llround(gain * 65536.0));
+    }
+    m_radial_luts.emplace_back(m_radial_luts.back());
+  }
+
+  m_values.resize(count);
+  m_out.resize(count);
+  m_compiled = true;
+}
+
+void
+AxisProcessor::process(std::span<int const> values, std::span<int> out)
+{
+  if (!m_compiled) {
+    compile();
+  }
+
+  size_t const count = m_configs.size();
+  assert(values.size() == count);
+  assert(out.size() == count);
+
+  // raw values to Q15
+  for (size_t i = 0; i < count; ++i)
+  {
+    int64_t const pos = std::clamp(int64_t{values[i]} - m_in_min[i], int64_t{0}, m_in_span[i]);
+    uint64_t const t = (static_cast<uint64_t>(pos) * m_index_scale[i] + (1 << 15)) >> 16;
+    int32_t const* lut = m_luts.data() + m_lut_offset[i] + (t >> 16);
+    int64_t const frac = static_cast<int64_t>(t & 0xffff);
+    m_values[i] = static_cast<int32_t>(lut[0] + ((int64_t{lut[1] - lut[0]} * frac + (1 << 15)) >> 16));
+  }
+
+  // radial deadzone and curve
+  for (size_t p = 0; p < m_radial_pairs.size(); ++p)
+  {
+    RadialPair const& pair = m_radial_pairs[p];
+    int64_t const x = m_values[pair.x_axis];
+    int64_t const y = m_values[pair.y_axis];
+
+    int64_t const r = std::llround(std::sqrt(static_cast<double>(x * x + y * y)));
+    int64_t const t = (std::min(r, RADIAL_MAX) << 16) * RADIAL_LUT_SIZE / RADIAL_MAX;
+    int64_t const* lut = m_radial_luts.data() + p * (RADIAL_LUT_SIZE + 2) + (t >> 16);
+    int64_t const frac = t & 0xffff;
+    int64_t const gain = lut[0] + (((lut[1] - lut[0]) * frac + (1 << 15)) >> 16);
+
+    m_values[pair.x_axis] = static_cast<int32_t>(std::clamp((x * gain + (1 << 15)) >> 16, -Q15_MAX, Q15_MAX));
+    m_values[pair.y_axis] = static_cast<int32_t>(std::clamp((y * gain + (1 << 15)) >> 16, -Q15_MAX, Q15_MAX));
+  }
+
+  // Q15 to the output range
+  for (size_t i = 0; i < count; ++i)
+  {
+    int64_t const v = int64_t{m_values[i]} + Q15_MAX;
+    out[i] = static_cast<int>(m_out_min[i] + ((v * m_out_scale[i] + (1 << 23)) >> 24));
+  }
+}
+
+void
+AxisProcessor::send(std::span<int const> values)
+{
+  if (!m_compiled) {
+    compile();
+  }
+
+  process(values, m_out);
+
+  for (size_t i = 0; i < m_emitters.size(); ++i) {
+    m_emitters[i]->send(m_out[i]);
+  }
+}
+
+} // namespace uinpp
+
+/* EOF */
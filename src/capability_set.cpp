@@ -0,0 +1,214 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "capability_set.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace uinpp {
+
+namespace {
+
+void hash_combine(std::size_t& seed, std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+bool absinfo_equal(input_absinfo const& lhs, input_absinfo const& rhs)
+{
+  return
+    lhs.minimum == rhs.minimum &&
+    lhs.maximum == rhs.maximum &&
+    lhs.fuzz == rhs.fuzz &&
+    lhs.flat == rhs.flat &&
+    lhs.resolution == rhs.resolution;
+}
+
+} // namespace
+
+CapabilitySet::CapabilitySet() :
+  m_key_bits(),
+  m_rel_bits(),
+  m_abs_bits(),
+  m_ff_bits(),
+  m_msc_bits(),
+  m_led_bits(),
+  m_prop_bits(),
+  m_abs_setup()
+{
+}
+
+void
+CapabilitySet::add_key(uint16_t code)
+{
+  m_key_bits.set(code);
+}
+
+void
+CapabilitySet::add_rel(uint16_t code)
+{
+  m_rel_bits.set(code);
+}
+
+void
+CapabilitySet::add_abs(uint16_t code, int min, int max, int fuzz, int flat, int resolution)
+{
+  m_abs_bits.set(code);
+
+  uinput_abs_setup abs_setup;
+  memset(&abs_setup, 0, sizeof(abs_setup));
+
+  abs_setup.code = code;
+  abs_setup.absinfo.minimum = min;
+  abs_setup.absinfo.maximum = max;
+  abs_setup.absinfo.fuzz = fuzz;
+  abs_setup.absinfo.flat = flat;
+  abs_setup.absinfo.resolution = resolution;
+
+  auto it = std::lower_bound(m_abs_setup.begin(), m_abs_setup.end(), code,
+                             [](uinput_abs_setup const& lhs, uint16_t rhs) {
+                               return lhs.code < rhs;
+                             });
+  if (it != m_abs_setup.end() && it->code == code) {
+    *it = abs_setup;
+  } else {
+    m_abs_setup.insert(it, abs_setup);
+  }
+}
+
+void
+CapabilitySet::add_ff(uint16_t code)
+{
+  m_ff_bits.set(code);
+}
+
+void
+CapabilitySet::add_msc(uint16_t code)
+{
+  m_msc_bits.set(code);
+}
+
+void
+CapabilitySet::add_led(uint16_t code)
+{
+  m_led_bits.set(code);
+}
+
+void
+CapabilitySet::add_prop(uint16_t prop)
+{
+  m_prop_bits.set(prop);
+}
+
+bool
+CapabilitySet::empty() const
+{
+  return
+    m_key_bits.none() &&
+    m_rel_bits.none() &&
+    m_abs_bits.none() &&
+    m_ff_bits.none() &&
+    m_msc_bits.none() &&
+    m_led_bits.none() &&
+    m_prop_bits.none();
+}
+
+input_absinfo const*
+CapabilitySet::get_absinfo(uint16_t code) const
+{
+  auto it = std::lower_bound(m_abs_setup.begin(), m_abs_setup.end(), code,
+                             [](uinput_abs_setup const& lhs, uint16_t rhs) {
+                               return lhs.code < rhs;
+                             });
+  if (it != m_abs_setup.end() && it->code == code) {
+    return &it->absinfo;
+  } else {
+    return nullptr;
+  }
+}
+
+CapabilitySet&
+CapabilitySet::operator|=(CapabilitySet const& rhs)
+{
+  m_key_bits |= rhs.m_key_bits;
+  m_rel_bits |= rhs.m_rel_bits;
+  m_ff_bits |= rhs.m_ff_bits;
+  m_msc_bits |= rhs.m_msc_bits;
+  m_led_bits |= rhs.m_led_bits;
+  m_prop_bits |= rhs.m_prop_bits;
+
+  for (auto const& abs_setup : rhs.m_abs_setup) {
+    add_abs(abs_setup.code,
+            abs_setup.absinfo.minimum, abs_setup.absinfo.maximum,
+            abs_setup.absinfo.fuzz, abs_setup.absinfo.flat,
+            abs_setup.absinfo.resolution);
+  }
+
+  return *this;
+}
+
+bool
+CapabilitySet::operator==(CapabilitySet const& rhs) const
+{
+  if (m_key_bits != rhs.m_key_bits ||
+      m_rel_bits != rhs.m_rel_bits ||
+      m_abs_bits != rhs.m_abs_bits ||
+      m_ff_bits != rhs.m_ff_bits ||
+      m_msc_bits != rhs.m_msc_bits ||
+      m_led_bits != rhs.m_led_bits ||
+      m_prop_bits != rhs.m_prop_bits)
+  {
+    return false;
+  }
+
+  // m_abs_bits are equal, so both lists hold the same codes in the same order
+  for (size_t i = 0; i < m_abs_setup.size(); ++i)
+  {
+    if (!absinfo_equal(m_abs_setup[i].absinfo, rhs.m_abs_setup[i].absinfo)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::size_t
+CapabilitySet::hash() const
+{
+  std::size_t seed = std::hash<std::bitset<KEY_CNT>>()(m_key_bits);
+  hash_combine(seed, std::hash<std::bitset<REL_CNT>>()(m_rel_bits));
+  hash_combine(seed, std::hash<std::bitset<ABS_CNT>>()(m_abs_bits));
+  hash_combine(seed, std::hash<std::bitset<FF_CNT>>()(m_ff_bits));
+  hash_combine(seed, std::hash<std::bitset<MSC_CNT>>()(m_msc_bits));
+  hash_combine(seed, std::hash<std::bitset<LED_CNT>>()(m_led_bits));
+  hash_combine(seed, std::hash<std::bitset<INPUT_PROP_CNT>>()(m_prop_bits));
+
+  for (auto const& abs_setup : m_abs_setup)
+  {
+    hash_combine(seed, std::hash<int>()(abs_setup.absinfo.minimum));
+    hash_combine(seed, std::hash<int>()(abs_setup.absinfo.maximum));
+    hash_combine(seed, std::hash<int>()(abs_setup.absinfo.fuzz));
+    hash_combine(seed, std::hash<int>()(abs_setup.absinfo.flat));
+    hash_combine(seed, std::hash<int>()(abs_setup.absinfo.resolution));
+  }
+
+  return seed;
+}
+
+} // namespace uinpp
+
+/* EOF */
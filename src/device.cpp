@@ -16,43 +16,110 @@
 
 #include "device.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cctype>
+#include <chrono>
 #include <errno.h>
 #include <fcntl.h>
+#include <filesystem>
 #include <sstream>
 #include <stdexcept>
+#include <sys/socket.h>
 #include <unistd.h>
+#include <utility>
 
 #include <fmt/format.h>
-#include <logmich/log.hpp>
+#include "log.hpp"
 
 #include "force_feedback_handler.hpp"
+#include "trace.hpp"
 
 namespace uinpp {
 
+struct Device::PendingOutput
+{
+  uint64_t abs_mask;
+  std::array<int32_t, ABS_CNT> abs;
+  uint32_t rel_mask;
+  std::array<int32_t, REL_CNT> rel;
+
+  /** all events that aren't ABS or REL, in order, fixed capacity */
+  std::vector<input_event> events;
+};
+
+namespace {
+
+static_assert(ABS_CNT <= 64, "PendingOutput::abs_mask is too small");
+static_assert(REL_CNT <= 32, "PendingOutput::rel_mask is too small");
+
+uint64_t steady_nsec()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
 Device::Device(DeviceType device_type, std::string const& name,
                const struct input_id& iid) :
   m_device_type(device_type),
   m_iid(iid),
   m_name(name),
+  m_phys(),
+  m_backend(DeviceBackend::UINPUT),
   m_finished(false),
+  m_trace_id(0),
   m_fd(-1),
-  m_key_bit(false),
-  m_rel_bit(false),
-  m_abs_bit(false),
-  m_led_bit(false),
-  m_ff_bit(false),
+  m_loopback_fd(-1),
+  m_caps(),
+  m_mandatory_caps_added(false),
   m_ff_handler(nullptr),
   m_ff_callback(),
-  m_needs_sync(true)
+  m_state(),
+  m_state_callback(),
+  m_needs_sync(true),
+  m_frame(),
+  m_retry_queue(),
+  m_retry_offset(0),
+  m_errno(0),
+  m_frame_start(0),
+  m_own_stats(std::make_unique<DeviceStats>()),
+  m_stats(m_own_stats.get()),
+  m_output_interval(0),
+  m_output_elapsed(0),
+  m_output_pending(false),
+  m_pending()
+{
+  uinpp_log_debug("{} {}:{}", m_name, iid.vendor, iid.product);
+
+  // reserve once, so that sending never allocates
+  m_frame.reserve(64);
+  m_retry_queue.reserve(256);
+}
+
+Device::~Device()
 {
-  log_debug("{} {}:{}", m_name, iid.vendor, iid.product);
+  if (m_fd >= 0)
+  {
+    if (m_backend == DeviceBackend::UINPUT) {
+      ioctl(m_fd, UI_DEV_DESTROY);
+    }
+    close(m_fd);
+  }
 
-  std::fill_n(m_abs_lst, ABS_CNT, false);
-  std::fill_n(m_rel_lst, REL_CNT, false);
-  std::fill_n(m_key_lst, KEY_CNT, false);
-  std::fill_n(m_ff_lst,  FF_CNT,  false);
+  if (m_loopback_fd >= 0)
+  {
+    close(m_loopback_fd);
+  }
+}
 
+void
+Device::open_uinput()
+{
   // Open the input device
   char const* uinput_filename[] = { "/dev/input/uinput", "/dev/uinput", "/dev/misc/uinput" };
   const int uinput_filename_count = static_cast<int>(sizeof(uinput_filename)/sizeof(char const*));
@@ -88,114 +155,98 @@ Device::Device(DeviceType device_type, std::string const& name,
   }
 }
 
-Device::~Device()
+void
+Device::open_loopback()
 {
-  ioctl(m_fd, UI_DEV_DESTROY);
-  close(m_fd);
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) < 0) {
+    throw std::runtime_error(fmt::format("socketpair() failed: {}", strerror(errno)));
+  }
+
+  m_fd = sv[0];
+  m_loopback_fd = sv[1];
+}
+
+void
+Device::set_backend(DeviceBackend backend)
+{
+  assert(!m_finished);
+  m_backend = backend;
 }
 
 void
 Device::set_phys(std::string_view phys)
 {
-  std::string phys_str(phys);
-  if (ioctl(m_fd, UI_SET_PHYS, phys_str.c_str()) < 0) {
-    throw std::runtime_error(fmt::format("Device::set_phys() failed: ", strerror(errno)));
-  }
+  m_phys = phys;
 }
 
 void
 Device::set_prop(int value)
 {
-  if (ioctl(m_fd, UI_SET_PROPBIT, value) < 0) {
-    throw std::runtime_error(fmt::format("Device::set_prop() failed: ", strerror(errno)));
-  }
+  m_caps.add_prop(static_cast<uint16_t>(value));
 }
 
 void
 Device::add_abs(uint16_t code, int min, int max, int fuzz, int flat, int resolution)
 {
-  log_debug("add_abs: {} ({}, {})", code, min, max);
+  uinpp_log_debug("add_abs: {} ({}, {})", code, min, max);
 
-  if (!m_abs_lst[code])
+  if (!m_caps.has_abs(code))
   {
-    m_abs_lst[code] = true;
-
-    if (!m_abs_bit)
-    {
-      ioctl(m_fd, UI_SET_EVBIT, EV_ABS);
-      m_abs_bit = true;
-    }
-
-    uinput_abs_setup abs_setup;
-    memset(&abs_setup, 0, sizeof(abs_setup));
-
-    abs_setup.code = code;
-    abs_setup.absinfo.minimum = min;
-    abs_setup.absinfo.maximum = max;
-    abs_setup.absinfo.fuzz = fuzz;
-    abs_setup.absinfo.flat = flat;
-    abs_setup.absinfo.resolution = resolution;
-
-    if (ioctl(m_fd, UI_ABS_SETUP, &abs_setup) < 0) {
-      throw std::runtime_error(fmt::format("UI_ABS_SETUP failed: {}", strerror(errno)));
-    }
+    m_caps.add_abs(code, min, max, fuzz, flat, resolution);
   }
 }
 
 void
 Device::add_rel(uint16_t code)
 {
-  log_debug("add_rel: {} {}", code, m_name);
-
-  if (!m_rel_lst[code])
-  {
-    m_rel_lst[code] = true;
+  uinpp_log_debug("add_rel: {} {}", code, m_name);
 
-    if (!m_rel_bit)
-    {
-      ioctl(m_fd, UI_SET_EVBIT, EV_REL);
-      m_rel_bit = true;
-    }
-
-    ioctl(m_fd, UI_SET_RELBIT, code);
-  }
+  m_caps.add_rel(code);
 }
 
 void
 Device::add_key(uint16_t code)
 {
-  log_debug("add_key: {} {}", code, m_name);
+  uinpp_log_debug("add_key: {} {}", code, m_name);
 
-  if (!m_key_lst[code])
-  {
-    m_key_lst[code] = true;
+  m_caps.add_key(code);
+}
 
-    if (!m_key_bit)
-    {
-      ioctl(m_fd, UI_SET_EVBIT, EV_KEY);
-      m_key_bit = true;
-    }
+void
+Device::add_ff(uint16_t code)
+{
+  m_caps.add_ff(code);
 
-    ioctl(m_fd, UI_SET_KEYBIT, code);
+  if (!m_ff_handler)
+  {
+    m_ff_handler = new ForceFeedbackHandler();
   }
 }
 
 void
-Device::add_ff(uint16_t code)
+Device::add_msc(uint16_t code)
 {
-  if (!m_ff_lst[code])
-  {
-    m_ff_lst[code] = true;
+  m_caps.add_msc(code);
+}
 
-    if (!m_ff_bit)
-    {
-      ioctl(m_fd, UI_SET_EVBIT, EV_FF);
-      m_ff_bit = true;
-      assert(m_ff_handler == nullptr);
-      m_ff_handler = new ForceFeedbackHandler();
-    }
+void
+Device::add_led(uint16_t code)
+{
+  m_caps.add_led(code);
+}
+
+void
+Device::add_capabilities(CapabilitySet const& caps)
+{
+  // axes that are already registered keep their absinfo
+  CapabilitySet merged = caps;
+  merged |= m_caps;
+  m_caps = merged;
 
-    ioctl(m_fd, UI_SET_FFBIT, code);
+  if (m_caps.has_ffs() && !m_ff_handler)
+  {
+    m_ff_handler = new ForceFeedbackHandler();
   }
 }
 
@@ -206,9 +257,32 @@ Device::set_ff_callback(const std::function<void (uint8_t, uint8_t)>& callback)
 }
 
 void
-Device::finish()
+Device::set_state_callback(std::function<void (DeviceStateSnapshot const&)> const& callback)
 {
-  assert(!m_finished);
+  m_state_callback = callback;
+}
+
+void
+Device::reset_state()
+{
+  m_state.store(DeviceStateSnapshot{});
+}
+
+void
+Device::publish_state(DeviceStateSnapshot const& state)
+{
+  if (m_state.store(state) && m_state_callback) {
+    m_state_callback(state);
+  }
+}
+
+void
+Device::add_mandatory_capabilities()
+{
+  if (m_mandatory_caps_added) {
+    return;
+  }
+  m_mandatory_caps_added = true;
 
   // Create some mandatory events that are needed for the kernel/Xorg
   // to register the device as its proper type
@@ -226,26 +300,177 @@ Device::finish()
       add_rel(REL_X);
       add_rel(REL_Y);
       add_key(BTN_LEFT);
+
+      // the hi-res wheels make libinput ignore the legacy ones,
+      // MultiDevice::send() mirrors REL_WHEEL/REL_HWHEEL into them
+      add_rel(REL_WHEEL);
+      add_rel(REL_HWHEEL);
+      add_rel(REL_WHEEL_HI_RES);
+      add_rel(REL_HWHEEL_HI_RES);
       break;
 
     case DeviceType::JOYSTICK:
       // the kernel and SDL have different rules for joystick
       // detection, so this is more a hack then a proper solution
-      if (!m_key_lst[BTN_A])
+      if (!m_caps.has_key(BTN_A))
       {
         add_key(BTN_A);
       }
 
-      if (!m_abs_lst[ABS_X])
+      if (!m_caps.has_abs(ABS_X))
       {
         add_abs(ABS_X, -1, 1, 0, 0);
       }
 
-      if (!m_abs_lst[ABS_Y])
+      if (!m_caps.has_abs(ABS_Y))
       {
         add_abs(ABS_Y, -1, 1, 0, 0);
       }
       break;
+
+    case DeviceType::TOUCHPAD:
+    case DeviceType::TOUCHSCREEN:
+      set_prop(m_device_type == DeviceType::TOUCHPAD ? INPUT_PROP_POINTER : INPUT_PROP_DIRECT);
+      add_key(BTN_TOUCH);
+
+      // libinput only treats devices with BTN_TOOL_FINGER as touchpad
+      // and doesn't accept a touchpad without any button
+      if (m_device_type == DeviceType::TOUCHPAD)
+      {
+        add_key(BTN_TOOL_FINGER);
+        if (!m_caps.has_key(BTN_LEFT)) {
+          add_key(BTN_LEFT);
+        }
+      }
+
+      // single touch emulation for clients that don't know multitouch
+      static constexpr std::pair<uint16_t, uint16_t> single_touch_axes[] = {
+        { ABS_MT_POSITION_X, ABS_X },
+        { ABS_MT_POSITION_Y, ABS_Y }
+      };
+      for (auto const& [mt_code, code] : single_touch_axes)
+      {
+        input_absinfo const* absinfo = m_caps.get_absinfo(mt_code);
+        if (absinfo && !m_caps.has_abs(code)) {
+          add_abs(code, absinfo->minimum, absinfo->maximum,
+                  absinfo->fuzz, absinfo->flat, absinfo->resolution);
+        }
+      }
+      break;
+
+    case DeviceType::SENSOR:
+      // without the property udev tags the device as joystick, the
+      // timestamp lets clients integrate the gyro over the real sample
+      // interval instead of the arrival time
+      set_prop(INPUT_PROP_ACCELEROMETER);
+      add_msc(MSC_TIMESTAMP);
+      break;
+
+    case DeviceType::TABLET:
+      // libinput and udev only accept a tablet with a pen tool, a
+      // tablet without a property is taken to be a screen tablet
+      if (!m_caps.has_prop(INPUT_PROP_POINTER)) {
+        set_prop(INPUT_PROP_DIRECT);
+      }
+      add_key(BTN_TOOL_PEN);
+      add_key(BTN_TOUCH);
+      break;
+  }
+}
+
+void
+Device::finish()
+{
+  assert(!m_finished);
+
+  add_mandatory_capabilities();
+
+  if (m_backend == DeviceBackend::LOOPBACK)
+  {
+    open_loopback();
+    m_finished = true;
+    return;
+  }
+  else if (m_backend == DeviceBackend::NONE)
+  {
+    m_finished = true;
+    return;
+  }
+
+  open_uinput();
+
+  if (!m_phys.empty())
+  {
+    if (ioctl(m_fd, UI_SET_PHYS, m_phys.c_str()) < 0) {
+      throw std::runtime_error(fmt::format("Device::set_phys() failed: {}", strerror(errno)));
+    }
+  }
+
+  for (uint16_t prop = 0; prop < INPUT_PROP_CNT; ++prop)
+  {
+    if (m_caps.has_prop(prop) && ioctl(m_fd, UI_SET_PROPBIT, prop) < 0) {
+      throw std::runtime_error(fmt::format("Device::set_prop() failed: {}", strerror(errno)));
+    }
+  }
+
+  if (m_caps.has_keys())
+  {
+    ioctl(m_fd, UI_SET_EVBIT, EV_KEY);
+    for (uint16_t code = 0; code < KEY_CNT; ++code) {
+      if (m_caps.has_key(code)) {
+        ioctl(m_fd, UI_SET_KEYBIT, code);
+      }
+    }
+  }
+
+  if (m_caps.has_rels())
+  {
+    ioctl(m_fd, UI_SET_EVBIT, EV_REL);
+    for (uint16_t code = 0; code < REL_CNT; ++code) {
+      if (m_caps.has_rel(code)) {
+        ioctl(m_fd, UI_SET_RELBIT, code);
+      }
+    }
+  }
+
+  if (m_caps.has_abses())
+  {
+    ioctl(m_fd, UI_SET_EVBIT, EV_ABS);
+    for (uinput_abs_setup abs_setup : m_caps.get_abs_setup()) {
+      if (ioctl(m_fd, UI_ABS_SETUP, &abs_setup) < 0) {
+        throw std::runtime_error(fmt::format("UI_ABS_SETUP failed: {}", strerror(errno)));
+      }
+    }
+  }
+
+  if (m_caps.has_ffs())
+  {
+    ioctl(m_fd, UI_SET_EVBIT, EV_FF);
+    for (uint16_t code = 0; code < FF_CNT; ++code) {
+      if (m_caps.has_ff(code)) {
+        ioctl(m_fd, UI_SET_FFBIT, code);
+      }
+    }
+  }
+
+  if (m_caps.has_leds())
+  {
+    ioctl(m_fd, UI_SET_EVBIT, EV_LED);
+    for (uint16_t code = 0; code < LED_CNT; ++code) {
+      if (m_caps.has_led(code)) {
+        ioctl(m_fd, UI_SET_LEDBIT, code);
+      }
+    }
+  }
+
+  if (m_caps.has_mscs())
+  {
+    ioctl(m_fd, UI_SET_EVBIT, EV_MSC);
+    for (uint16_t code = 0; code < MSC_CNT; ++code) {
+      if (m_caps.has_msc(code)) {
+        ioctl(m_fd, UI_SET_MSCBIT, code);
+      }
+    }
   }
 
   {
@@ -257,13 +482,13 @@ Device::finish()
     strncpy(setup.name, m_name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
     setup.name[UINPUT_MAX_NAME_SIZE - 1] = '\0';
 
-    if (m_ff_bit) {
+    if (m_ff_handler) {
       setup.ff_effects_max = m_ff_handler->get_max_effects();
     } else {
       setup.ff_effects_max = 0;
     }
 
-    log_debug("'{}' {}:{}", setup.name, setup.id.vendor, setup.id.product);
+    uinpp_log_debug("'{}' {}:{}", setup.name, setup.id.vendor, setup.id.product);
 
     if (ioctl(m_fd, UI_DEV_SETUP, &setup) < 0) {
       throw std::runtime_error(fmt::format("UI_DEV_SETUP failed: {}", strerror(errno)));
@@ -273,7 +498,7 @@ Device::finish()
   // FIXME: check that the config isn't empty and give a more
   // meaningful message when it is
 
-  log_debug("finish");
+  uinpp_log_debug("finish");
   if (ioctl(m_fd, UI_DEV_CREATE))
   {
     throw std::runtime_error(fmt::format("unable to create uinput device: '{}': ", m_name, strerror(errno)));
@@ -282,15 +507,150 @@ Device::finish()
   m_finished = true;
 }
 
+std::string
+Device::get_sysname() const
+{
+  assert(m_finished);
+
+  char sysname[64];
+  int const len = ioctl(m_fd, UI_GET_SYSNAME(sizeof(sysname)), sysname);
+  if (len < 0) {
+    throw std::runtime_error(fmt::format("UI_GET_SYSNAME failed: {}", strerror(errno)));
+  }
+
+  sysname[sizeof(sysname) - 1] = '\0';
+  return sysname;
+}
+
+std::string
+Device::get_syspath() const
+{
+  return "/sys/devices/virtual/input/" + get_sysname();
+}
+
+std::string
+Device::get_evdev_path() const
+{
+  return find_device_node("event");
+}
+
+std::string
+Device::get_jsdev_path() const
+{
+  return find_device_node("js");
+}
+
+std::string
+Device::find_device_node(std::string_view prefix) const
+{
+  // the input handlers (evdev, joydev) register their devices as
+  // children of the input device, e.g. .../input23/event17
+  std::error_code ec;
+  for (auto const& entry : std::filesystem::directory_iterator(get_syspath(), ec))
+  {
+    std::string const name = entry.path().filename().string();
+    if (name.starts_with(prefix) &&
+        name.size() > prefix.size() &&
+        std::isdigit(static_cast<unsigned char>(name[prefix.size()])))
+    {
+      return "/dev/input/" + name;
+    }
+  }
+
+  if (ec) {
+    throw std::runtime_error(fmt::format("failed to read {}: {}", get_syspath(), ec.message()));
+  }
+
+  return {};
+}
+
 void
 Device::send(uint16_t type, uint16_t code, int32_t value)
 {
+  if (try_send(type, code, value) == SendStatus::ERROR) {
+    throw std::runtime_error(fmt::format("uinput: send failed: {}", strerror(m_errno)));
+  }
+}
+
+void
+Device::sync()
+{
+  if (try_sync() == SendStatus::ERROR) {
+    throw std::runtime_error(fmt::format("uinput: sync failed: {}", strerror(m_errno)));
+  }
+}
+
+void
+Device::send_events(std::span<input_event const> events)
+{
+  if (try_send_events(events) == SendStatus::ERROR) {
+    throw std::runtime_error(fmt::format("uinput: send failed: {}", strerror(m_errno)));
+  }
+}
+
+SendStatus
+Device::try_send_events(std::span<input_event const> events) noexcept
+{
+  if (events.empty()) {
+    return SendStatus::OK;
+  }
+
+  // whatever is in the frame buffer was send first
+  SendStatus const status = write_frame();
+
+  for (input_event const& ev : events)
+  {
+    trace(m_trace_id, TracePhase::SEND, ev.type, ev.code, ev.value);
+    if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+      stats_add(m_stats->syncs, 1);
+    }
+  }
+
+  return std::max(status, write_buffer(events.data(), events.size(), 0));
+}
+
+SendStatus
+Device::try_send(uint16_t type, uint16_t code, int32_t value) noexcept
+{
+  if (m_output_interval > 0) {
+    return coalesce_event(type, code, value);
+  }
+
+  return append_event(type, code, value);
+}
+
+SendStatus
+Device::try_sync() noexcept
+{
+  if (m_output_interval > 0) {
+    // the frame is written on the next output tick in update()
+    return SendStatus::OK;
+  }
+
+  return sync_frame();
+}
+
+SendStatus
+Device::append_event(uint16_t type, uint16_t code, int32_t value) noexcept
+{
+  SendStatus status = SendStatus::OK;
+
+  if (m_frame.size() == m_frame.capacity())
+  {
+    // frame doesn't fit into the buffer, write out what we have
+    status = write_frame();
+  }
+
   m_needs_sync = true;
 
+  if (m_frame.empty()) {
+    m_frame_start = steady_nsec();
+  }
+
+  // the timestamp is left empty as the kernel stamps the events itself
   struct input_event ev;
   memset(&ev, 0, sizeof(ev));
 
-  gettimeofday(&ev.time, NULL);
   ev.type  = type;
   ev.code  = code;
   if (ev.type == EV_KEY)
@@ -298,54 +658,371 @@ Device::send(uint16_t type, uint16_t code, int32_t value)
   else
     ev.value = value;
 
-  if (write(m_fd, &ev, sizeof(ev)) < 0)
-    throw std::runtime_error(std::string("uinput:send_button: ") + strerror(errno));
+  m_frame.push_back(ev);
+  trace(m_trace_id, TracePhase::SEND, ev.type, ev.code, ev.value);
+
+  return status;
+}
+
+SendStatus
+Device::sync_frame() noexcept
+{
+  if (!m_needs_sync || !m_finished) {
+    return SendStatus::OK;
+  }
+
+  trace(m_trace_id, TracePhase::SYNC, EV_SYN, SYN_REPORT, static_cast<int32_t>(m_frame.size()));
+  stats_add(m_stats->syncs, 1);
+
+  SendStatus const status = append_event(EV_SYN, SYN_REPORT, 0);
+  m_needs_sync = false;
+  return std::max(status, write_frame());
+}
+
+SendStatus
+Device::write_frame() noexcept
+{
+  if (m_frame.empty()) {
+    return SendStatus::OK;
+  }
+
+  SendStatus const status = write_buffer(m_frame.data(), m_frame.size(), m_frame_start);
+  m_frame.clear();
+  return status;
+}
+
+SendStatus
+Device::write_buffer(input_event const* events, size_t count, uint64_t start_nsec) noexcept
+{
+  SendStatus status = SendStatus::OK;
+
+  // older frames are written first to keep the order
+  SendStatus const flushed = flush();
+
+  if (!m_finished)
+  {
+    stats_add(m_stats->dropped_events, count);
+    status = SendStatus::DROPPED;
+  }
+  else if (flushed == SendStatus::ERROR)
+  {
+    // the fd is broken, don't let the queue hide it
+    stats_add(m_stats->dropped_events, count);
+    status = SendStatus::ERROR;
+  }
+  else if (flushed != SendStatus::OK)
+  {
+    // older frames are still waiting
+    status = queue_events(events, count);
+  }
+  else
+  {
+    ssize_t const ret = write_bytes(events, count * sizeof(input_event));
+    int const err = errno;
+    trace(m_trace_id, TracePhase::WRITE, 0, 0, ret >= 0 ? static_cast<int32_t>(ret) : -err);
+    stats_add(m_stats->write_calls, 1);
+
+    if (ret >= 0)
+    {
+      size_t const written = static_cast<size_t>(ret) / sizeof(input_event);
+      stats_add(m_stats->events_written, written);
+      stats_add(m_stats->bytes_written, static_cast<uint64_t>(ret));
+      if (start_nsec != 0) {
+        m_stats->send_latency.record(steady_nsec() - start_nsec);
+      }
+
+      size_t const partial = static_cast<size_t>(ret) % sizeof(input_event);
+      if (partial != 0)
+      {
+        // the rest of a split event has to follow, or the stream gets
+        // out of step, the queue is empty here, so it always fits
+        m_retry_offset = partial;
+        m_retry_queue.push_back(events[written]);
+        status = written + 1 < count ?
+          queue_events(events + written + 1, count - written - 1) :
+          SendStatus::QUEUED;
+      }
+      else if (written < count)
+      {
+        status = queue_events(events + written, count - written);
+      }
+    }
+    else if (err == EAGAIN || err == EINTR)
+    {
+      status = queue_events(events, count);
+    }
+    else
+    {
+      m_errno = err;
+      stats_add(m_stats->dropped_events, count);
+      status = SendStatus::ERROR;
+    }
+  }
+
+  if (status == SendStatus::DROPPED || status == SendStatus::ERROR) {
+    stats_add(m_stats->dropped_frames, 1);
+  }
+
+  return status;
+}
+
+ssize_t
+Device::write_bytes(void const* data, size_t len) noexcept
+{
+  if (m_backend == DeviceBackend::NONE) {
+    return static_cast<ssize_t>(len);
+  }
+
+  return write(m_fd, data, len);
+}
+
+SendStatus
+Device::queue_events(input_event const* events, size_t count) noexcept
+{
+  if (m_retry_queue.size() + count > m_retry_queue.capacity())
+  {
+    stats_add(m_stats->dropped_events, count);
+    return SendStatus::DROPPED;
+  }
+
+  m_retry_queue.insert(m_retry_queue.end(), events, events + count);
+  return SendStatus::QUEUED;
+}
+
+SendStatus
+Device::flush() noexcept
+{
+  if (m_retry_queue.empty()) {
+    return SendStatus::OK;
+  }
+
+  ssize_t const ret = write_bytes(reinterpret_cast<char const*>(m_retry_queue.data()) + m_retry_offset,
+                                  m_retry_queue.size() * sizeof(input_event) - m_retry_offset);
+  int const err = errno;
+  trace(m_trace_id, TracePhase::FLUSH, 0, 0, ret >= 0 ? static_cast<int32_t>(ret) : -err);
+  stats_add(m_stats->write_calls, 1);
+  if (ret >= 0)
+  {
+    size_t const done = m_retry_offset + static_cast<size_t>(ret);
+    size_t const written = done / sizeof(input_event);
+    m_retry_offset = done % sizeof(input_event);
+    stats_add(m_stats->retried_events, written);
+    stats_add(m_stats->events_written, written);
+    stats_add(m_stats->bytes_written, static_cast<uint64_t>(ret));
+    m_retry_queue.erase(m_retry_queue.begin(), m_retry_queue.begin() + static_cast<ptrdiff_t>(written));
+    return m_retry_queue.empty() ? SendStatus::OK : SendStatus::QUEUED;
+  }
+  else if (err == EAGAIN || err == EINTR)
+  {
+    return SendStatus::QUEUED;
+  }
+  else
+  {
+    m_errno = err;
+    stats_add(m_stats->dropped_events, m_retry_queue.size());
+    m_retry_queue.clear();
+    m_retry_offset = 0;
+    return SendStatus::ERROR;
+  }
 }
 
 void
-Device::sync()
+Device::set_output_interval(int msec)
 {
-  if (m_needs_sync)
+  msec = std::max(msec, 0);
+
+  if (msec > 0 && m_caps.has_abs(ABS_MT_SLOT)) {
+    // merging ABS_MT_SLOT and the per slot axes would break protocol B
+    throw std::runtime_error(fmt::format("{}: output interval not supported for multitouch devices", m_name));
+  }
+
+  if (msec == 0)
   {
-    send(EV_SYN, SYN_REPORT, 0);
-    m_needs_sync = false;
+    write_pending();
+    m_pending.reset();
   }
+  else if (!m_pending)
+  {
+    m_pending = std::make_unique<PendingOutput>();
+    // reserve once, so that coalescing never allocates
+    m_pending->events.reserve(64);
+  }
+
+  m_output_interval = msec;
+  m_output_elapsed = 0;
+}
+
+SendStatus
+Device::coalesce_event(uint16_t type, uint16_t code, int32_t value) noexcept
+{
+  SendStatus status = SendStatus::OK;
+
+  if (type == EV_SYN)
+  {
+    // frames are formed on the output tick
+  }
+  else if (type == EV_ABS && code < ABS_CNT)
+  {
+    uint64_t const bit = uint64_t{1} << code;
+    if (m_pending->abs_mask & bit) {
+      stats_add(m_stats->coalesced_events, 1);
+    }
+    m_pending->abs_mask |= bit;
+    m_pending->abs[code] = value;
+  }
+  else if (type == EV_REL && code < REL_CNT)
+  {
+    uint32_t const bit = uint32_t{1} << code;
+    if (m_pending->rel_mask & bit) {
+      stats_add(m_stats->coalesced_events, 1);
+      m_pending->rel[code] += value;
+    } else {
+      m_pending->rel[code] = value;
+    }
+    m_pending->rel_mask |= bit;
+  }
+  else
+  {
+    if (m_pending->events.size() == m_pending->events.capacity())
+    {
+      // more transitions than fit into one tick, write them out early
+      // instead of losing edges
+      status = write_pending();
+    }
+
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    m_pending->events.push_back(ev);
+  }
+
+  m_output_pending = true;
+
+  return status;
+}
+
+SendStatus
+Device::write_pending() noexcept
+{
+  if (!m_output_pending) {
+    return SendStatus::OK;
+  }
+
+  SendStatus status = SendStatus::OK;
+
+  PendingOutput& pending = *m_pending;
+
+  for (uint64_t mask = pending.abs_mask; mask != 0; mask &= mask - 1)
+  {
+    uint16_t const code = static_cast<uint16_t>(std::countr_zero(mask));
+    status = std::max(status, append_event(EV_ABS, code, pending.abs[code]));
+  }
+
+  for (uint32_t mask = pending.rel_mask; mask != 0; mask &= mask - 1)
+  {
+    uint16_t const code = static_cast<uint16_t>(std::countr_zero(mask));
+    if (pending.rel[code] != 0) {
+      status = std::max(status, append_event(EV_REL, code, pending.rel[code]));
+    }
+  }
+
+  // a second transition of the same code goes into a new frame, as
+  // consumers only look at the final state of a frame
+  size_t frame_begin = 0;
+  for (size_t i = 0; i < pending.events.size(); ++i)
+  {
+    input_event const& ev = pending.events[i];
+    for (size_t j = frame_begin; j < i; ++j)
+    {
+      if (pending.events[j].type == ev.type && pending.events[j].code == ev.code)
+      {
+        status = std::max(status, sync_frame());
+        frame_begin = i;
+        break;
+      }
+    }
+
+    status = std::max(status, append_event(ev.type, ev.code, ev.value));
+  }
+
+  status = std::max(status, sync_frame());
+
+  pending.abs_mask = 0;
+  pending.rel_mask = 0;
+  pending.events.clear();
+  m_output_pending = false;
+
+  return status;
 }
 
 void
 Device::update(int msec_delta)
 {
-  if (m_ff_bit)
+  uint64_t const start = steady_nsec();
+
+  if (!m_retry_queue.empty())
   {
-    assert(m_ff_handler);
+    flush();
+  }
 
-    m_ff_handler->update(msec_delta);
+  if (m_output_interval > 0)
+  {
+    m_output_elapsed += msec_delta;
+    if (m_output_elapsed >= m_output_interval)
+    {
+      // a late tick writes a single frame, there is no catching up
+      m_output_elapsed %= m_output_interval;
+      write_pending();
+    }
+  }
 
-    log_info("{:5d} {:5d}", m_ff_handler->get_strong_magnitude(), m_ff_handler->get_weak_magnitude());
+  if (m_ff_handler)
+  {
+    m_ff_handler->update(msec_delta);
 
     if (m_ff_callback)
     {
       m_ff_callback(static_cast<unsigned char>(m_ff_handler->get_strong_magnitude() / 128),
                     static_cast<unsigned char>(m_ff_handler->get_weak_magnitude()   / 128));
     }
+
+    DeviceStateSnapshot state = m_state.load();
+    state.strong_magnitude = static_cast<uint16_t>(m_ff_handler->get_strong_magnitude());
+    state.weak_magnitude = static_cast<uint16_t>(m_ff_handler->get_weak_magnitude());
+    publish_state(state);
   }
+
+  m_stats->update_duration.record(steady_nsec() - start);
 }
 
 void
 Device::read()
 {
+  if (!m_finished || m_fd < 0) {
+    return;
+  }
+
   struct input_event ev;
   ssize_t ret;
+  uint64_t events = 0;
+
+  // published once for all events read, not per event
+  DeviceStateSnapshot state = m_state.load();
 
   while((ret = ::read(m_fd, &ev, sizeof(ev))) == sizeof(ev))
   {
+    trace(m_trace_id, TracePhase::READ, ev.type, ev.code, ev.value);
+    events += 1;
+
     switch(ev.type)
     {
       case EV_LED:
-        if (ev.code == LED_MISC)
+        if (ev.code < LED_CNT)
         {
-          // FIXME: implement this
-          log_info("unimplemented: set LED status: {}", ev.value);
+          uint16_t const bit = static_cast<uint16_t>(1u << ev.code);
+          state.leds = static_cast<uint16_t>(ev.value ? (state.leds | bit) : (state.leds & ~bit));
         }
         break;
 
@@ -354,6 +1031,7 @@ Device::read()
         {
           case FF_GAIN:
             m_ff_handler->set_gain(ev.value);
+            state.ff_gain = static_cast<uint16_t>(ev.value);
             break;
 
           default:
@@ -379,6 +1057,7 @@ Device::read()
 
               ioctl(m_fd, UI_BEGIN_FF_UPLOAD, &upload);
               m_ff_handler->upload(upload.effect);
+              stats_add(m_stats->ff_uploads, 1);
               upload.retval = 0;
 
               ioctl(m_fd, UI_END_FF_UPLOAD, &upload);
@@ -397,6 +1076,7 @@ Device::read()
 
               ioctl(m_fd, UI_BEGIN_FF_ERASE, &erase);
               m_ff_handler->erase(erase.effect_id);
+              stats_add(m_stats->ff_erases, 1);
               erase.retval = 0;
 
               ioctl(m_fd, UI_END_FF_ERASE, &erase);
@@ -404,17 +1084,21 @@ Device::read()
             break;
 
           default:
-            log_warn("unhandled event code read");
+            uinpp_log_warn("unhandled event code read");
             break;
         }
         break;
 
       default:
-        log_warn("unhandled event type read: {}", ev.type);
+        uinpp_log_warn("unhandled event type read: {}", ev.type);
         break;
     }
   }
 
+  // the last read() is the one that came back empty
+  stats_add(m_stats->read_calls, events + 1);
+  stats_add(m_stats->read_events, events);
+
   if (ret == 0)
   {
     // ok, no more data
@@ -423,13 +1107,59 @@ Device::read()
   {
     if (errno != EAGAIN)
     {
-      log_error("failed to read from file description: {}: {}", ret, strerror(errno));
+      uinpp_log_error("failed to read from file description: {}: {}", ret, strerror(errno));
     }
   }
   else
   {
-    log_error("short read: {}", ret);
+    uinpp_log_error("short read: {}", ret);
   }
+
+  publish_state(state);
+}
+
+void
+Device::count_dropped_events(uint64_t count) noexcept
+{
+  stats_add(m_stats->dropped_events, count);
+}
+
+void
+Device::set_stats_storage(DeviceStats* stats)
+{
+  if (stats)
+  {
+    m_own_stats.reset();
+    m_stats = stats;
+  }
+  else
+  {
+    if (!m_own_stats) {
+      m_own_stats = std::make_unique<DeviceStats>();
+    }
+    m_stats = m_own_stats.get();
+  }
+}
+
+DeviceStats*
+Device::get_stats_storage() const
+{
+  return m_own_stats ? nullptr : m_stats;
+}
+
+std::size_t
+Device::get_memory_usage() const
+{
+  return
+    sizeof(Device) +
+    m_name.capacity() +
+    m_phys.capacity() +
+    m_caps.get_abs_setup().capacity() * sizeof(uinput_abs_setup) +
+    m_frame.capacity() * sizeof(input_event) +
+    m_retry_queue.capacity() * sizeof(input_event) +
+    (m_pending ? sizeof(PendingOutput) + m_pending->events.capacity() * sizeof(input_event) : 0) +
+    (m_own_stats ? sizeof(DeviceStats) : 0) +
+    (m_ff_handler ? sizeof(ForceFeedbackHandler) : 0);
 }
 
 } // namespace uinpp
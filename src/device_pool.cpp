@@ -0,0 +1,118 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_pool.hpp"
+
+#include <cassert>
+
+#include "log.hpp"
+
+namespace uinpp {
+
+bool
+DeviceSignature::operator==(DeviceSignature const& rhs) const
+{
+  return
+    type == rhs.type &&
+    name == rhs.name &&
+    phys == rhs.phys &&
+    id.bustype == rhs.id.bustype &&
+    id.vendor == rhs.id.vendor &&
+    id.product == rhs.id.product &&
+    id.version == rhs.id.version &&
+    caps == rhs.caps;
+}
+
+std::size_t
+DeviceSignature::hash() const
+{
+  std::size_t seed = caps.hash();
+  seed ^= std::hash<std::string>()(name) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  seed ^= std::hash<uint64_t>()((uint64_t{id.bustype} << 48) |
+                                (uint64_t{id.vendor} << 32) |
+                                (uint64_t{id.product} << 16) |
+                                uint64_t{id.version}) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+DeviceSignature
+make_device_signature(Device const& device)
+{
+  return DeviceSignature{
+    device.get_type(),
+    device.get_name(),
+    device.get_phys(),
+    device.get_id(),
+    device.get_capabilities()
+  };
+}
+
+DevicePool::DevicePool() :
+  m_devices()
+{
+}
+
+DevicePool::~DevicePool()
+{
+}
+
+void
+DevicePool::release(std::unique_ptr<Device> device)
+{
+  assert(device->is_finished());
+
+  uinpp_log_debug("releasing device to pool: '{}'", device->get_name());
+
+  device->set_ff_callback({});
+  device->set_state_callback({});
+  device->reset_state();
+  device->set_output_interval(0);
+  DeviceSignature signature = make_device_signature(*device);
+  m_devices.emplace(std::move(signature), std::move(device));
+}
+
+std::unique_ptr<Device>
+DevicePool::acquire(DeviceSignature const& signature)
+{
+  auto it = m_devices.find(signature);
+  if (it == m_devices.end()) {
+    return {};
+  }
+
+  uinpp_log_debug("acquiring device from pool: '{}'", signature.name);
+
+  std::unique_ptr<Device> device = std::move(it->second);
+  m_devices.erase(it);
+  return device;
+}
+
+void
+DevicePool::read()
+{
+  for (auto& it : m_devices) {
+    it.second->read();
+  }
+}
+
+void
+DevicePool::clear()
+{
+  m_devices.clear();
+}
+
+} // namespace uinpp
+
+/* EOF */
@@ -0,0 +1,95 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_reaper.hpp"
+
+#include "log.hpp"
+
+#include "device.hpp"
+
+namespace uinpp {
+
+DeviceReaper::DeviceReaper() :
+  m_mutex(),
+  m_cond(),
+  m_idle_cond(),
+  m_queue(),
+  m_busy(false),
+  m_quit(false),
+  m_thread()
+{
+  m_thread = std::thread(&DeviceReaper::run, this);
+}
+
+DeviceReaper::~DeviceReaper()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit = true;
+  }
+  m_cond.notify_one();
+  m_thread.join();
+}
+
+void
+DeviceReaper::dispose(std::unique_ptr<Device> device)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.emplace_back(std::move(device));
+  }
+  m_cond.notify_one();
+}
+
+void
+DeviceReaper::wait_idle()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle_cond.wait(lock, [this]{ return m_queue.empty() && !m_busy; });
+}
+
+void
+DeviceReaper::run()
+{
+  std::vector<std::unique_ptr<Device>> devices;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_cond.wait(lock, [this]{ return m_quit || !m_queue.empty(); });
+
+    if (m_queue.empty() && m_quit) {
+      break;
+    }
+
+    // destroy the devices outside of the lock, so that dispose()
+    // never has to wait for the kernel
+    devices.swap(m_queue);
+    m_busy = true;
+    lock.unlock();
+
+    uinpp_log_debug("destroying {} device(s)", devices.size());
+    devices.clear();
+
+    lock.lock();
+    m_busy = false;
+    m_idle_cond.notify_all();
+  }
+}
+
+} // namespace uinpp
+
+/* EOF */
@@ -0,0 +1,88 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "device_stats.hpp"
+
+namespace uinpp {
+
+uint64_t
+LatencyHistogram::get_percentile(double quantile) const
+{
+  uint64_t const count = get_count();
+  if (count == 0) {
+    return 0;
+  }
+
+  uint64_t const rank = static_cast<uint64_t>(quantile * static_cast<double>(count - 1));
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < BUCKETS; ++bucket)
+  {
+    seen += get_bucket(bucket);
+    if (seen > rank) {
+      return (uint64_t{1} << (bucket + 1)) - 1;
+    }
+  }
+
+  // buckets and count were read at slightly different times
+  return (uint64_t{1} << BUCKETS) - 1;
+}
+
+void
+LatencyHistogram::reset() noexcept
+{
+  m_count.store(0, std::memory_order_relaxed);
+  m_sum.store(0, std::memory_order_relaxed);
+  for (auto& bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+DeviceStats::DeviceStats() :
+  events_written(0),
+  bytes_written(0),
+  write_calls(0),
+  read_calls(0),
+  syncs(0),
+  dropped_frames(0),
+  dropped_events(0),
+  retried_events(0),
+  ff_uploads(0),
+  ff_erases(0),
+  read_events(0),
+  coalesced_events(0),
+  send_latency(),
+  update_duration()
+{
+}
+
+void
+DeviceStats::reset() noexcept
+{
+  for (std::atomic<uint64_t>* counter : {
+      &events_written, &bytes_written, &write_calls, &read_calls, &syncs,
+      &dropped_frames, &dropped_events, &retried_events,
+      &ff_uploads, &ff_erases, &read_events, &coalesced_events })
+  {
+    counter->store(0, std::memory_order_relaxed);
+  }
+
+  send_latency.reset();
+  update_duration.reset();
+}
+
+} // namespace uinpp
+
+/* EOF */
@@ -17,21 +17,29 @@
 #include "event_collector.hpp"
 
 #include <cassert>
+#include <stdexcept>
 
-#include <logmich/log.hpp>
+#include <fmt/format.h>
+
+#include "log.hpp"
 
 #include "multi_device.hpp"
 
 namespace uinpp {
 
 EventCollector::EventCollector(MultiDevice& uinput,
-                                   uint32_t device_id,
-                                   int type,
-                                   int code) :
+                               Arena& arena,
+                               uint32_t device_id,
+                               int type,
+                               int code,
+                               MergePolicy merge_policy) :
   m_uinput(uinput),
+  m_arena(arena),
   m_device_id(device_id),
   m_type(type),
-  m_code(code)
+  m_code(code),
+  m_merge_policy(merge_policy),
+  m_neutral(0)
 {
   assert(m_code != -1);
 }
@@ -40,6 +48,18 @@ EventCollector::~EventCollector()
 {
 }
 
+void
+EventCollector::set_merge_policy(MergePolicy policy, int neutral)
+{
+  if (!supports_merge_policy(policy)) {
+    throw std::runtime_error(fmt::format("merge policy {} not supported for event type {} code {}",
+                                         static_cast<int>(policy), m_type, m_code));
+  }
+
+  m_merge_policy = policy;
+  m_neutral = neutral;
+}
+
 } // namespace uinpp
 
 /* EOF */
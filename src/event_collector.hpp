@@ -21,8 +21,10 @@
 #include <memory>
 #include <vector>
 
+#include "arena.hpp"
 #include "fwd.hpp"
 #include "event_emitter.hpp"
+#include "merge_policy.hpp"
 
 namespace uinpp {
 
@@ -30,21 +32,45 @@ class EventCollector
 {
 protected:
   MultiDevice& m_uinput;
+
+  /** emitters are allocated from the arena, next to their collector */
+  Arena& m_arena;
+
   uint32_t m_device_id;
   int m_type;
   int m_code;
 
+  MergePolicy m_merge_policy;
+
+  /** value of an idle emitter */
+  int m_neutral;
+
 public:
-  EventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code);
+  EventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code,
+                 MergePolicy merge_policy);
   virtual ~EventCollector();
 
   uint32_t get_device_id() const { return m_device_id; }
   int      get_type() const { return m_type; }
   int      get_code() const { return m_code; }
 
+  /** Throws if \a policy doesn't apply to the event type */
+  void set_merge_policy(MergePolicy policy, int neutral);
+  MergePolicy get_merge_policy() const { return m_merge_policy; }
+
   virtual EventEmitter* create_emitter() = 0;
+  virtual std::size_t get_emitter_count() const = 0;
+
+  /** Send the merged value of the emitters, if it changed since the
+      last sync() */
   virtual void sync() = 0;
 
+  /** Return the collector to its neutral state, e.g. release held keys */
+  virtual void reset() = 0;
+
+protected:
+  virtual bool supports_merge_policy(MergePolicy policy) const = 0;
+
 private:
   EventCollector(EventCollector const&);
   EventCollector& operator=(EventCollector const&);
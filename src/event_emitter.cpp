@@ -18,7 +18,7 @@
 
 #include <cassert>
 
-#include <logmich/log.hpp>
+#include "log.hpp"
 
 #include "multi_device.hpp"
 
@@ -0,0 +1,192 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "filter_bank.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "event_emitter.hpp"
+
+namespace uinpp {
+
+namespace {
+
+/** shortest time between reports the filters assume, reports with
+    the same or an out of order timestamp count as this far apart */
+constexpr float min_dt = 0.0001f;
+
+/** The per axis arrays never overlap, the restrict qualified
+    parameters let the compiler vectorize the loop without runtime
+    alias checks */
+void filter_axes(size_t count, float inv_dt, int const* __restrict in,
+                 float const* __restrict ema_alpha,
+                 float const* __restrict one_euro,
+                 float const* __restrict min_cutoff,
+                 float const* __restrict beta,
+                 float const* __restrict d_cutoff,
+                 float const* __restrict hysteresis,
+                 float* __restrict last_raw,
+                 float* __restrict value,
+                 float* __restrict speed,
+                 int* __restrict last_out)
+{
+  constexpr float two_pi = 2.0f * std::numbers::pi_v<float>;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    float const raw = static_cast<float>(in[i]);
+
+    // smoothing factor of a low pass with the given cutoff:
+    // 1 / (1 + tau / dt) with tau = 1 / (2 pi cutoff)
+    float const d_alpha = 1.0f / (1.0f + inv_dt / (two_pi * d_cutoff[i]));
+    float const v = speed[i] + d_alpha * ((raw - last_raw[i]) * inv_dt - speed[i]);
+
+    float const cutoff = min_cutoff[i] + beta[i] * std::abs(v);
+    float const one_euro_alpha = 1.0f / (1.0f + inv_dt / (two_pi * cutoff));
+    float const alpha = one_euro[i] * one_euro_alpha + (1.0f - one_euro[i]) * ema_alpha[i];
+
+    float const x = value[i] + alpha * (raw - value[i]);
+
+    // computed unconditionally and blended, a branch would keep the
+    // loop from being vectorized
+    int const rounded = static_cast<int>(x + std::copysign(0.5f, x));
+    int const prev = last_out[i];
+    int const moved = std::abs(x - static_cast<float>(prev)) > hysteresis[i];
+
+    speed[i] = v;
+    last_raw[i] = raw;
+    value[i] = x;
+    last_out[i] = prev + (rounded - prev) * moved;
+  }
+}
+
+} // namespace
+
+FilterBank::FilterBank() :
+  m_emitters(),
+  m_ema_alpha(),
+  m_one_euro(),
+  m_min_cutoff(),
+  m_beta(),
+  m_d_cutoff(),
+  m_hysteresis(),
+  m_raw(),
+  m_value(),
+  m_speed(),
+  m_out(),
+  m_sent(),
+  m_primed(false),
+  m_sent_valid(false)
+{
+}
+
+FilterBank::~FilterBank()
+{
+}
+
+int
+FilterBank::add_axis(EventEmitter* emitter, FilterConfig const& config)
+{
+  if (config.alpha <= 0.0f || config.alpha > 1.0f ||
+      config.min_cutoff <= 0.0f || config.d_cutoff <= 0.0f ||
+      config.beta < 0.0f || config.hysteresis < 0.0f)
+  {
+    throw std::runtime_error(fmt::format("FilterBank: invalid filter config for axis {}", m_emitters.size()));
+  }
+
+  m_emitters.emplace_back(emitter);
+
+  // NONE is an EMA that takes the new sample as is
+  m_ema_alpha.emplace_back(config.type == FilterType::EMA ? config.alpha : 1.0f);
+  m_one_euro.emplace_back(config.type == FilterType::ONE_EURO ? 1.0f : 0.0f);
+  m_min_cutoff.emplace_back(config.min_cutoff);
+  m_beta.emplace_back(config.beta);
+  m_d_cutoff.emplace_back(config.d_cutoff);
+  m_hysteresis.emplace_back(config.hysteresis);
+
+  m_raw.emplace_back(0.0f);
+  m_value.emplace_back(0.0f);
+  m_speed.emplace_back(0.0f);
+  m_out.emplace_back(0);
+  m_sent.emplace_back(0);
+
+  reset();
+
+  return static_cast<int>(m_emitters.size()) - 1;
+}
+
+void
+FilterBank::process(std::span<int const> values, float dt, std::span<int> out)
+{
+  size_t const count = m_emitters.size();
+  assert(values.size() == count);
+  assert(out.size() == count);
+
+  if (!m_primed)
+  {
+    // nothing to derive a speed from, take the values as they are
+    for (size_t i = 0; i < count; ++i) {
+      m_raw[i] = static_cast<float>(values[i]);
+      m_value[i] = m_raw[i];
+      m_speed[i] = 0.0f;
+      m_out[i] = values[i];
+    }
+    m_primed = true;
+  }
+  else
+  {
+    filter_axes(count, 1.0f / std::max(dt, min_dt), values.data(),
+                m_ema_alpha.data(), m_one_euro.data(), m_min_cutoff.data(), m_beta.data(),
+                m_d_cutoff.data(), m_hysteresis.data(),
+                m_raw.data(), m_value.data(), m_speed.data(), m_out.data());
+  }
+
+  if (out.data() != m_out.data()) {
+    std::copy(m_out.begin(), m_out.end(), out.begin());
+  }
+}
+
+void
+FilterBank::send(std::span<int const> values, float dt)
+{
+  process(values, dt, m_out);
+
+  for (size_t i = 0; i < m_emitters.size(); ++i)
+  {
+    if (!m_sent_valid || m_out[i] != m_sent[i]) {
+      m_emitters[i]->send(m_out[i]);
+      m_sent[i] = m_out[i];
+    }
+  }
+  m_sent_valid = true;
+}
+
+void
+FilterBank::reset()
+{
+  m_primed = false;
+  m_sent_valid = false;
+}
+
+} // namespace uinpp
+
+/* EOF */
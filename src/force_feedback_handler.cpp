@@ -19,7 +19,7 @@
 #include <algorithm>
 #include <cmath>
 
-#include <logmich/log.hpp>
+#include "log.hpp"
 
 std::ostream& operator<<(std::ostream& out, const struct ff_envelope& envelope)
 {
@@ -204,7 +204,7 @@ ForceFeedbackEffect::ForceFeedbackEffect(const struct ff_effect& effect) :
       // case FF_FRICTION:
       // case FF_DAMPER
       // case FF_INERTIA:
-      log_info("unsupported effect: {}", effect);
+      uinpp_log_info("unsupported effect: {}", effect);
       start_weak_magnitude   = 0;
       start_strong_magnitude = 0;
       end_weak_magnitude     = 0;
@@ -272,8 +272,9 @@ ForceFeedbackEffect::stop()
 
 ForceFeedbackHandler::ForceFeedbackHandler() :
   gain(0xFFFF),
-  max_effects(16),
+  max_effects(MAX_EFFECTS),
   effects(),
+  uploaded(),
   weak_magnitude(0),
   strong_magnitude(0)
 {
@@ -294,17 +295,21 @@ ForceFeedbackHandler::get_max_effects()
 void
 ForceFeedbackHandler::upload(const struct ff_effect& effect)
 {
-  log_debug("FF_UPLOAD(effect_id: {}, effect_type: {}, effect: {})",
+  uinpp_log_debug("FF_UPLOAD(effect_id: {}, effect_type: {}, effect: {})",
             effect.id, effect.type, effect);
 
-  auto const i = effects.find(effect.id);
-  if (i == effects.end())
+  if (effect.id < 0 || effect.id >= MAX_EFFECTS)
+  {
+    uinpp_log_warn("effect id out of range: {}", effect.id);
+  }
+  else if (!uploaded[effect.id])
   {
     effects[effect.id] = ForceFeedbackEffect(effect);
+    uploaded[effect.id] = true;
   }
   else
   {
-    ForceFeedbackEffect old_effect = i->second;
+    ForceFeedbackEffect old_effect = effects[effect.id];
     ForceFeedbackEffect new_effect(effect);
 
     // We the copy state variables of the effect , so we can update
@@ -314,55 +319,53 @@ ForceFeedbackHandler::upload(const struct ff_effect& effect)
     new_effect.weak_magnitude   = old_effect.weak_magnitude;
     new_effect.strong_magnitude = old_effect.strong_magnitude;
 
-    effects[effect.id] = effect;
+    effects[effect.id] = new_effect;
   }
 }
 
 void
 ForceFeedbackHandler::erase(int id)
 {
-  log_debug("FF_ERASE(effect_id: {})", id);
+  uinpp_log_debug("FF_ERASE(effect_id: {})", id);
 
-  auto const i = effects.find(id);
-  if (i != effects.end())
+  if (id >= 0 && id < MAX_EFFECTS && uploaded[id])
   {
-    effects.erase(i);
+    effects[id] = ForceFeedbackEffect();
+    uploaded[id] = false;
   }
   else
   {
-    log_warn("unknown id {}", id);
+    uinpp_log_warn("unknown id {}", id);
   }
 }
 
 void
 ForceFeedbackHandler::play(int id)
 {
-  log_debug("FFPlay(effect_id: })", id);
+  uinpp_log_debug("FFPlay(effect_id: {})", id);
 
-  auto const i = effects.find(id);
-  if (i != effects.end())
+  if (id >= 0 && id < MAX_EFFECTS && uploaded[id])
   {
-    i->second.play();
+    effects[id].play();
   }
   else
   {
-    log_warn("unknown id {}", id);
+    uinpp_log_warn("unknown id {}", id);
   }
 }
 
 void
 ForceFeedbackHandler::stop(int id)
 {
-  log_debug("FFStop(effect_id:{})", id);
+  uinpp_log_debug("FFStop(effect_id:{})", id);
 
-  auto const i = effects.find(id);
-  if (i != effects.end())
+  if (id >= 0 && id < MAX_EFFECTS && uploaded[id])
   {
-    i->second.stop();
+    effects[id].stop();
   }
   else
   {
-    log_warn("unknown id {}", id);
+    uinpp_log_warn("unknown id {}", id);
   }
 }
 
@@ -378,14 +381,14 @@ ForceFeedbackHandler::update(int msec_delta)
   weak_magnitude   = 0;
   strong_magnitude = 0;
 
-  if (!effects.empty())
+  if (uploaded.any())
   {
-    for(auto i = effects.begin(); i != effects.end(); ++i)
+    for(auto& effect : effects)
     {
-      i->second.update(msec_delta);
+      effect.update(msec_delta);
 
-      weak_magnitude   += i->second.get_weak_magnitude();
-      strong_magnitude += i->second.get_strong_magnitude();
+      weak_magnitude   += effect.get_weak_magnitude();
+      strong_magnitude += effect.get_strong_magnitude();
     }
 
     weak_magnitude   = std::min(weak_magnitude,   0x7fff);
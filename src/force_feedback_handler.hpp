@@ -17,8 +17,9 @@
 #ifndef HEADER_UINPP_FORCE_FEEDBACK_HANDLER_HPP
 #define HEADER_UINPP_FORCE_FEEDBACK_HANDLER_HPP
 
+#include <array>
+#include <bitset>
 #include <linux/input.h>
-#include <map>
 
 namespace uinpp {
 
@@ -83,9 +84,14 @@ public:
 class ForceFeedbackHandler
 {
 private:
+  static constexpr int MAX_EFFECTS = 16;
+
   int gain;
   int max_effects;
-  std::map<int, ForceFeedbackEffect> effects;
+
+  /** indexed by effect id, the kernel hands out ids below max_effects */
+  std::array<ForceFeedbackEffect, MAX_EFFECTS> effects;
+  std::bitset<MAX_EFFECTS> uploaded;
 
   int weak_magnitude;
   int strong_magnitude;
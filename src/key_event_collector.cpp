@@ -18,23 +18,24 @@
 
 #include <cassert>
 
-#include <logmich/log.hpp>
+#include "log.hpp"
 
 #include "multi_device.hpp"
 
 namespace uinpp {
 
-KeyEventCollector::KeyEventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code) :
-  EventCollector(uinput, device_id, type, code),
-  m_emitters(),
-  m_value(0)
+KeyEventCollector::KeyEventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code) :
+  EventCollector(uinput, arena, device_id, type, code, MergePolicy::OR),
+  m_emitters(&arena),
+  m_value(0),
+  m_output(0)
 {
 }
 
 EventEmitter*
 KeyEventCollector::create_emitter()
 {
-  m_emitters.emplace_back(std::make_unique<KeyEventEmitter>(*this));
+  m_emitters.emplace_back(m_arena.create<KeyEventEmitter>(*this));
   return m_emitters.back().get();
 }
 
@@ -47,29 +48,26 @@ KeyEventCollector::send(int value)
   {
     if (m_value >= static_cast<int>(m_emitters.size()))
     {
-      log_error("got press event while all emitter where already pressed");
+      uinpp_log_error("got press event while all emitter where already pressed");
     }
 
     m_value += 1;
-
-    if (m_value == 1)
-    {
-      m_uinput.send(get_device_id(), get_type(), get_code(), m_value);
-    }
   }
   else
   {
     if (m_value <= 0)
     {
-      log_error("got release event while collector was in release state");
+      uinpp_log_error("got release event while collector was in release state");
     }
 
     m_value -= 1;
+  }
 
-    if (m_value == 0)
-    {
-      m_uinput.send(get_device_id(), get_type(), get_code(), 0);
-    }
+  int const output = (m_merge_policy == MergePolicy::LAST_WRITER) ? value : (m_value > 0 ? 1 : 0);
+  if (output != m_output)
+  {
+    m_output = output;
+    m_uinput.send(get_device_id(), get_type(), get_code(), output);
   }
 }
 
@@ -78,6 +76,24 @@ KeyEventCollector::sync()
 {
 }
 
+void
+KeyEventCollector::reset()
+{
+  m_value = 0;
+
+  if (m_output > 0)
+  {
+    m_output = 0;
+    m_uinput.send(get_device_id(), get_type(), get_code(), 0);
+  }
+}
+
+bool
+KeyEventCollector::supports_merge_policy(MergePolicy policy) const
+{
+  return policy == MergePolicy::OR || policy == MergePolicy::LAST_WRITER;
+}
+
 } // namespace uinpp
 
 /* EOF */
@@ -27,17 +27,29 @@ namespace uinpp {
 class KeyEventCollector : public EventCollector
 {
 public:
-  KeyEventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code);
+  KeyEventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code);
 
   EventEmitter* create_emitter() override;
+  std::size_t get_emitter_count() const override { return m_emitters.size(); }
   void sync() override;
+  void reset() override;
 
+  /** Keys are send right away instead of on sync(), so that a press
+      and release within the same frame isn't lost */
   void send(int value);
 
+protected:
+  bool supports_merge_policy(MergePolicy policy) const override;
+
 private:
-  std::vector<std::unique_ptr<KeyEventEmitter>> m_emitters;
+  std::pmr::vector<ArenaPtr<KeyEventEmitter>> m_emitters;
+
+  /** number of pressed emitters */
   int m_value;
 
+  /** the state last send to the device */
+  int m_output;
+
 private:
   KeyEventCollector(KeyEventCollector const&);
   KeyEventCollector& operator=(KeyEventCollector const&);
@@ -16,11 +16,18 @@
 
 #include "linux.hpp"
 
+#include <cerrno>
 #include <cstdio>
 #include <linux/input.h>
+#include <poll.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/inotify.h>
 #include <unistd.h>
 #include <vector>
 
+#include <fmt/format.h>
+
 namespace uinpp {
 
 bool is_mouse_button(int ev_code)
@@ -61,6 +68,50 @@ int find_evdev_number()
   }
 }
 
+bool wait_for_device_node(std::string const& path, std::chrono::milliseconds timeout)
+{
+  if (access(path.c_str(), R_OK) == 0) {
+    return true;
+  }
+
+  int const fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error(fmt::format("inotify_init1() failed: {}", strerror(errno)));
+  }
+
+  // udev creates the node and then adjusts its permissions, so
+  // watch the directory for both
+  std::string const dirname = path.substr(0, path.rfind('/'));
+  if (inotify_add_watch(fd, dirname.c_str(), IN_CREATE | IN_ATTRIB | IN_MOVED_TO) < 0)
+  {
+    int const err = errno;
+    close(fd);
+    throw std::runtime_error(fmt::format("inotify_add_watch() failed: {}: {}", dirname, strerror(err)));
+  }
+
+  auto const deadline = std::chrono::steady_clock::now() + timeout;
+  bool ready = false;
+  while (!(ready = (access(path.c_str(), R_OK) == 0)))
+  {
+    auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      break;
+    }
+
+    pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, static_cast<int>(remaining.count())) > 0)
+    {
+      // drain the events, the access() check above is what counts
+      char buf[4096];
+      while (read(fd, buf, sizeof(buf)) > 0) {}
+    }
+  }
+
+  close(fd);
+  return ready;
+}
+
 } // namespace uinpp
 
 /* EOF */
@@ -0,0 +1,53 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_UINPP_LOG_HPP
+#define HEADER_UINPP_LOG_HPP
+
+#include <logmich/log.hpp>
+
+/** Compile-time minimum log level of the library. Calls below it are
+    discarded by the compiler, including the evaluation of their
+    arguments, runtime filtering by logmich still applies on top.
+    @{*/
+#define UINPP_LOG_LEVEL_NONE    0
+#define UINPP_LOG_LEVEL_ERROR   1
+#define UINPP_LOG_LEVEL_WARNING 2
+#define UINPP_LOG_LEVEL_INFO    3
+#define UINPP_LOG_LEVEL_DEBUG   4
+#define UINPP_LOG_LEVEL_TRACE   5
+
+#ifndef UINPP_LOG_LEVEL
+#  define UINPP_LOG_LEVEL UINPP_LOG_LEVEL_DEBUG
+#endif
+/** @} */
+
+#define UINPP_LOG_IF(level, logfn, ...)          \
+  do {                                          \
+    if constexpr (UINPP_LOG_LEVEL >= (level)) { \
+      logfn(__VA_ARGS__);                       \
+    }                                           \
+  } while (false)
+
+#define uinpp_log_error(...) UINPP_LOG_IF(UINPP_LOG_LEVEL_ERROR,   log_error, __VA_ARGS__)
+#define uinpp_log_warn(...)  UINPP_LOG_IF(UINPP_LOG_LEVEL_WARNING, log_warn,  __VA_ARGS__)
+#define uinpp_log_info(...)  UINPP_LOG_IF(UINPP_LOG_LEVEL_INFO,    log_info,  __VA_ARGS__)
+#define uinpp_log_debug(...) UINPP_LOG_IF(UINPP_LOG_LEVEL_DEBUG,   log_debug, __VA_ARGS__)
+#define uinpp_log_trace(...) UINPP_LOG_IF(UINPP_LOG_LEVEL_TRACE,   log_trace, __VA_ARGS__)
+
+#endif
+
+/* EOF */
@@ -0,0 +1,127 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "motion_sensor.hpp"
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "capability_set.hpp"
+#include "multi_device.hpp"
+
+namespace uinpp {
+
+namespace {
+
+/** all axes of a sample plus MSC_TIMESTAMP and SYN_REPORT */
+constexpr size_t max_events_per_sample = 8;
+
+constexpr uint16_t accel_codes[3] = { ABS_X, ABS_Y, ABS_Z };
+constexpr uint16_t gyro_codes[3] = { ABS_RX, ABS_RY, ABS_RZ };
+
+} // namespace
+
+MotionSensor::MotionSensor(MultiDevice& uinput, uint32_t device_id, MotionSensorConfig const& config) :
+  m_uinput(uinput),
+  m_device_id(device_id),
+  m_events(),
+  m_last(),
+  m_has_last(false)
+{
+  if (config.accel_resolution <= 0 || config.accel_range <= 0 ||
+      config.gyro_resolution <= 0 || config.gyro_range <= 0 ||
+      config.max_batch < 1)
+  {
+    throw std::runtime_error(fmt::format("MotionSensor: invalid config for device {}", device_id));
+  }
+
+  int const accel_max = config.accel_range * config.accel_resolution;
+  int const gyro_max = config.gyro_range * config.gyro_resolution;
+
+  CapabilitySet caps;
+  for (uint16_t code : accel_codes) {
+    caps.add_abs(code, -accel_max, accel_max, 0, 0, config.accel_resolution);
+  }
+  for (uint16_t code : gyro_codes) {
+    caps.add_abs(code, -gyro_max, gyro_max, 0, 0, config.gyro_resolution);
+  }
+  caps.add_msc(MSC_TIMESTAMP);
+
+  uinput.set_device_type(device_id, DeviceType::SENSOR);
+  uinput.add_capabilities(device_id, caps);
+
+  m_events.reserve(static_cast<size_t>(config.max_batch) * max_events_per_sample);
+}
+
+MotionSensor::~MotionSensor()
+{
+}
+
+void
+MotionSensor::send(ImuSample const& sample)
+{
+  send_batch(std::span<ImuSample const>(&sample, 1));
+}
+
+void
+MotionSensor::send_batch(std::span<ImuSample const> samples)
+{
+  if (samples.empty()) {
+    return;
+  }
+
+  m_events.clear();
+
+  for (ImuSample const& sample : samples)
+  {
+    for (size_t i = 0; i < 3; ++i)
+    {
+      if (!m_has_last || sample.accel[i] != m_last.accel[i]) {
+        append(EV_ABS, accel_codes[i], sample.accel[i]);
+      }
+    }
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+      if (!m_has_last || sample.gyro[i] != m_last.gyro[i]) {
+        append(EV_ABS, gyro_codes[i], sample.gyro[i]);
+      }
+    }
+
+    // the timestamp goes out even when nothing moved, so that clients
+    // see the sample rate of the sensor
+    append(EV_MSC, MSC_TIMESTAMP, static_cast<int>(sample.timestamp));
+    append(EV_SYN, SYN_REPORT, 0);
+
+    m_last = sample;
+    m_has_last = true;
+  }
+
+  m_uinput.send_events(m_device_id, m_events);
+}
+
+void
+MotionSensor::append(uint16_t type, uint16_t code, int value)
+{
+  // the timestamp is left empty as the kernel stamps the events itself
+  m_events.push_back(input_event{ {}, type, code, value });
+}
+
+} // namespace uinpp
+
+/* EOF */
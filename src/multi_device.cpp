@@ -16,20 +16,30 @@
 
 #include "multi_device.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <unistd.h>
 
-#include <logmich/log.hpp>
+#include <fmt/format.h>
+#include "log.hpp"
 
+#include "arena.hpp"
+#include "device_pool.hpp"
+#include "device_reaper.hpp"
 #include "parse.hpp"
 #include "abs_event_collector.hpp"
 #include "key_event_collector.hpp"
 #include "rel_event_collector.hpp"
+#include "stats_region.hpp"
+#include "trace.hpp"
 
 namespace uinpp {
 
@@ -88,14 +98,84 @@ MultiDevice::MultiDevice() :
   m_device_usbids(),
   m_device_phys(),
   m_device_prop(),
+  m_device_types(),
+  m_arena(std::make_unique<Arena>()),
   m_collectors(),
-  m_rel_repeat_lst(),
-  m_extra_events(true)
+  m_rel_repeats(),
+  m_scrolls(),
+  m_hires_mirrors(),
+  m_extra_events(true),
+  m_lazy(false),
+  m_backend(DeviceBackend::UINPUT),
+  m_lazy_devices(),
+  m_device_pool(nullptr),
+  m_device_reaper(nullptr),
+  m_stats_region(nullptr)
 {
 }
 
 MultiDevice::~MultiDevice()
 {
+  // lazy creations still in flight need the devices
+  for (auto& it : m_lazy_devices) {
+    if (it.second.creation.valid()) {
+      it.second.creation.wait();
+    }
+  }
+
+  if (m_device_pool || m_device_reaper)
+  {
+    // the kernel only releases held keys when the device is
+    // destroyed, which happens late or never for reaped and pooled
+    // devices, so release them here
+    try
+    {
+      poll_lazy_devices();
+
+      for (EventCollector* collector : m_collectors) {
+        if (get_uinput(collector->get_device_id())->is_finished()) {
+          collector->reset();
+        }
+      }
+
+      for (auto& it : m_devices) {
+        if (it.second->is_finished()) {
+          it.second->sync();
+        }
+      }
+    }
+    catch (std::exception const& err)
+    {
+      uinpp_log_error("failed to release held keys: {}", err.what());
+    }
+  }
+
+  if (m_stats_region)
+  {
+    for (auto& it : m_devices)
+    {
+      if (DeviceStats* stats = it.second->get_stats_storage()) {
+        it.second->set_stats_storage(nullptr);
+        m_stats_region->release(stats);
+      }
+    }
+  }
+
+  for (auto& it : m_devices)
+  {
+    if (m_device_pool && it.second->is_finished())
+    {
+      m_device_pool->release(std::move(it.second));
+    }
+    else if (m_device_reaper)
+    {
+      m_device_reaper->dispose(std::move(it.second));
+    }
+  }
+
+  for (EventCollector* collector : m_collectors) {
+    std::destroy_at(collector);
+  }
 }
 
 void
@@ -271,10 +351,14 @@ MultiDevice::create_uinput_device(uint32_t device_id)
   }
   else
   {
-    log_debug("create device: {}", device_id);
+    uinpp_log_debug("create device: {}", device_id);
     DeviceType device_type;
 
-    if (!m_extra_events)
+    if (auto type_it = m_device_types.find(device_id); type_it != m_device_types.end())
+    {
+      device_type = type_it->second;
+    }
+    else if (!m_extra_events)
     {
       device_type = DeviceType::GENERIC;
     }
@@ -302,6 +386,17 @@ MultiDevice::create_uinput_device(uint32_t device_id)
 
     std::string dev_name = get_device_name(device_id);
     auto dev = std::make_unique<Device>(device_type, dev_name, get_device_usbid(device_id));
+    dev->set_backend(m_backend);
+    dev->set_trace_id(device_id);
+
+    if (m_stats_region)
+    {
+      DeviceStats* stats = m_stats_region->acquire(device_id, dev_name);
+      if (!stats) {
+        uinpp_log_warn("stats region full, no stats for device: {}", device_id);
+      }
+      dev->set_stats_storage(stats);
+    }
 
     {
       auto prop_it = m_device_prop.find(device_id);
@@ -320,7 +415,7 @@ MultiDevice::create_uinput_device(uint32_t device_id)
     Device* dev_tmp = dev.get();
     m_devices[device_id] = std::move(dev);
 
-    log_debug("created uinput device: {} - '{}`", device_id, dev_name);
+    uinpp_log_debug("created uinput device: {} - '{}`", device_id, dev_name);
 
     return dev_tmp;
   }
@@ -377,6 +472,17 @@ MultiDevice::add_abs(uint32_t device_id, int ev_code, int min, int max, int fuzz
   return create_emitter(device_id, EV_ABS, ev_code);
 }
 
+input_absinfo const*
+MultiDevice::get_absinfo(uint32_t device_id, int ev_code) const
+{
+  auto const it = m_devices.find(device_id);
+  if (it == m_devices.end()) {
+    return nullptr;
+  }
+
+  return it->second->get_capabilities().get_absinfo(static_cast<uint16_t>(ev_code));
+}
+
 void
 MultiDevice::add_ff(uint32_t device_id, uint16_t code)
 {
@@ -384,6 +490,38 @@ MultiDevice::add_ff(uint32_t device_id, uint16_t code)
   dev->add_ff(code);
 }
 
+void
+MultiDevice::add_led(uint32_t device_id, uint16_t code)
+{
+  Device* dev = create_uinput_device(device_id);
+  dev->add_led(code);
+}
+
+void
+MultiDevice::set_merge_policy(uint32_t device_id, int ev_type, int ev_code, MergePolicy policy, int neutral)
+{
+  for (EventCollector* collector : m_collectors)
+  {
+    if (collector->get_device_id() == device_id &&
+        collector->get_type() == ev_type &&
+        collector->get_code() == ev_code)
+    {
+      collector->set_merge_policy(policy, neutral);
+      return;
+    }
+  }
+
+  throw std::runtime_error(fmt::format("set_merge_policy: no emitter for device {} type {} code {}",
+                                       device_id, ev_type, ev_code));
+}
+
+void
+MultiDevice::add_capabilities(uint32_t device_id, CapabilitySet const& caps)
+{
+  Device* dev = create_uinput_device(device_id);
+  dev->add_capabilities(caps);
+}
+
 EventEmitter*
 MultiDevice::create_emitter(int device_id, int type, int code)
 {
@@ -403,19 +541,19 @@ MultiDevice::create_emitter(int device_id, int type, int code)
   {
     case EV_ABS:
       {
-        m_collectors.push_back(std::make_unique<AbsEventCollector>(*this, device_id, type, code));
+        m_collectors.push_back(m_arena->create<AbsEventCollector>(*this, *m_arena, device_id, type, code));
         return m_collectors.back()->create_emitter();
       }
 
     case EV_KEY:
       {
-        m_collectors.push_back(std::make_unique<KeyEventCollector>(*this, device_id, type, code));
+        m_collectors.push_back(m_arena->create<KeyEventCollector>(*this, *m_arena, device_id, type, code));
         return m_collectors.back()->create_emitter();
       }
 
     case EV_REL:
       {
-        m_collectors.push_back(std::make_unique<RelEventCollector>(*this, device_id, type, code));
+        m_collectors.push_back(m_arena->create<RelEventCollector>(*this, *m_arena, device_id, type, code));
         return m_collectors.back()->create_emitter();
       }
 
@@ -425,13 +563,114 @@ MultiDevice::create_emitter(int device_id, int type, int code)
   }
 }
 
+bool
+MultiDevice::adopt_pooled_device(std::unique_ptr<Device>& device)
+{
+  if (!m_device_pool) {
+    return false;
+  }
+
+  // the pooled devices already carry their mandatory capabilities
+  device->add_mandatory_capabilities();
+
+  std::unique_ptr<Device> pooled = m_device_pool->acquire(make_device_signature(*device));
+  if (!pooled) {
+    return false;
+  }
+
+  pooled->set_ff_callback(device->get_ff_callback());
+  pooled->set_state_callback(device->get_state_callback());
+  pooled->set_trace_id(device->get_trace_id());
+  pooled->set_stats_storage(device->get_stats_storage());
+  pooled->set_output_interval(device->get_output_interval());
+  device = std::move(pooled);
+  return true;
+}
+
 void
 MultiDevice::finish()
 {
+  if (m_lazy)
+  {
+    for (auto& it : m_devices) {
+      if (!it.second->is_finished()) {
+        // final capabilities are needed before the device is created,
+        // e.g. for update_hires_mirrors()
+        it.second->add_mandatory_capabilities();
+        m_lazy_devices[it.first] = LazyDevice{ {}, {}, 0, false };
+      }
+    }
+    update_hires_mirrors();
+    return;
+  }
+
   for(auto i = m_devices.begin(); i != m_devices.end(); ++i)
   {
-    i->second->finish();
+    if (!adopt_pooled_device(i->second))
+    {
+      i->second->finish();
+    }
   }
+
+  update_hires_mirrors();
+}
+
+std::vector<DeviceFinishResult>
+MultiDevice::finish_parallel(unsigned int num_threads)
+{
+  if (m_lazy) {
+    finish();
+    return {};
+  }
+
+  std::vector<std::pair<uint32_t, Device*>> devices;
+  for (auto& it : m_devices) {
+    if (!adopt_pooled_device(it.second)) {
+      devices.emplace_back(it.first, it.second.get());
+    }
+  }
+
+  std::vector<DeviceFinishResult> results(devices.size());
+  std::atomic<size_t> next_idx = 0;
+
+  auto worker = [&devices, &results, &next_idx]
+  {
+    size_t idx;
+    while ((idx = next_idx.fetch_add(1)) < devices.size())
+    {
+      auto const start_time = std::chrono::steady_clock::now();
+
+      results[idx].device_id = devices[idx].first;
+      try {
+        devices[idx].second->finish();
+      } catch (...) {
+        results[idx].error = std::current_exception();
+      }
+
+      results[idx].duration = std::chrono::steady_clock::now() - start_time;
+    }
+  };
+
+  // the calling thread is used as one of the workers, jthread joins
+  // on destruction, so a failing thread creation doesn't leave
+  // threads behind that still use the locals
+  size_t const thread_count = std::min<size_t>(std::max(num_threads, 1u), devices.size());
+  std::vector<std::jthread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  threads.clear();
+
+  update_hires_mirrors();
+
+  for (auto const& result : results) {
+    uinpp_log_debug("finished device {} in {}us{}", result.device_id,
+              std::chrono::duration_cast<std::chrono::microseconds>(result.duration).count(),
+              result.error ? " (failed)" : "");
+  }
+
+  return results;
 }
 
 std::vector<Device*>
@@ -439,48 +678,137 @@ MultiDevice::get_devices() const
 {
   std::vector<Device*> result;
   for (auto& it : m_devices) {
-    result.emplace_back(it.second.get());
+    // a pending device might still be finished by its creation thread
+    if (!m_lazy_devices.count(it.first)) {
+      result.emplace_back(it.second.get());
+    }
   }
   return result;
 }
 
+MemoryUsage
+MultiDevice::get_memory_usage() const
+{
+  MemoryUsage usage{};
+
+  usage.arena_bytes_used = m_arena->get_bytes_used();
+  usage.arena_bytes_reserved = m_arena->get_bytes_reserved();
+
+  usage.collector_count = m_collectors.size();
+  for (EventCollector const* collector : m_collectors) {
+    usage.emitter_count += collector->get_emitter_count();
+  }
+
+  usage.device_count = m_devices.size();
+  for (auto const& it : m_devices) {
+    usage.device_bytes += it.second->get_memory_usage();
+  }
+
+  return usage;
+}
+
 void
 MultiDevice::send(uint32_t device_id, int ev_type, int ev_code, int value)
 {
+  if (ev_type == EV_REL && (ev_code == REL_WHEEL || ev_code == REL_HWHEEL))
+  {
+    int const hires_code = get_hires_mirror(device_id, ev_code);
+    if (hires_code >= 0) {
+      send_event(device_id, EV_REL, hires_code, value * 120);
+    }
+  }
+
+  send_event(device_id, ev_type, ev_code, value);
+}
+
+void
+MultiDevice::send_events(uint32_t device_id, std::span<input_event const> events)
+{
+  if (!m_lazy_devices.empty() && m_lazy_devices.count(device_id))
+  {
+    // the device doesn't exist yet, queue the frames one event at a
+    // time, the device might get adopted from the pool on the way
+    for (input_event const& ev : events)
+    {
+      if (ev.type != EV_SYN) {
+        send_event(device_id, ev.type, ev.code, ev.value);
+      } else if (m_lazy_devices.count(device_id)) {
+        sync_lazy_device(device_id);
+      } else {
+        get_uinput(device_id)->sync();
+      }
+    }
+    return;
+  }
+
+  get_uinput(device_id)->send_events(events);
+}
+
+void
+MultiDevice::send_event(uint32_t device_id, int ev_type, int ev_code, int value)
+{
+  if (!m_lazy_devices.empty() && m_lazy_devices.count(device_id))
+  {
+    send_lazy(device_id, ev_type, ev_code, value);
+    return;
+  }
+
   get_uinput(device_id)->send(static_cast<uint16_t>(ev_type), static_cast<uint16_t>(ev_code), value);
 }
 
 void
 MultiDevice::update(int msec_delta)
 {
-  for(auto i = m_rel_repeat_lst.begin(); i != m_rel_repeat_lst.end(); ++i)
+  trace(0, TracePhase::UPDATE, 0, 0, msec_delta);
+
+  for (RelRepeat& rel : m_rel_repeats)
   {
-    i->second.time_count += msec_delta;
+    // a late tick sends the sum of the missed intervals as one event
+    rel.remainder += rel.value * msec_delta;
 
-    // FIXME: shouldn't send out events multiple times, but accumulate
-    // them instead and send out only once
-    while (i->second.time_count >= i->second.repeat_interval)
+    int64_t const unit = rel.repeat_interval << 16;
+    int64_t const value = rel.remainder / unit;
+    if (value != 0)
     {
-      // value can be float, but be can only send out int, so keep
-      // track of the rest we don't send
-      int i_value = static_cast<int>(i->second.value + truncf(i->second.rest));
-      i->second.rest -= truncf(i->second.rest);
-      i->second.rest += i->second.value - truncf(i->second.value);
+      rel.remainder -= value * unit;
+      send(rel.device_id, EV_REL, rel.code,
+           static_cast<int>(std::clamp<int64_t>(value, INT32_MIN, INT32_MAX)));
+    }
+  }
+
+  for (Scroll& scroll : m_scrolls)
+  {
+    if (scroll.velocity == 0) {
+      continue;
+    }
 
-      get_uinput(i->second.code.get_device_id())->send(EV_REL, static_cast<uint16_t>(i->second.code.code), i_value);
-      i->second.time_count -= i->second.repeat_interval;
+    scroll.remainder += scroll.velocity * msec_delta;
+
+    int64_t const unit = int64_t{1000} << 16;
+    int64_t const value = scroll.remainder / unit;
+    if (value != 0)
+    {
+      scroll.remainder -= value * unit;
+      send_scroll(scroll.device_id, scroll.code,
+                  static_cast<int>(std::clamp<int64_t>(value, INT32_MIN, INT32_MAX)));
     }
   }
 
+  poll_lazy_devices();
+
   for(auto i = m_devices.begin(); i != m_devices.end(); ++i)
   {
-    i->second->update(msec_delta);
+    if (!m_lazy_devices.count(i->first)) {
+      i->second->update(msec_delta);
+    }
   }
 }
 
 void
 MultiDevice::sync()
 {
+  poll_lazy_devices();
+
   for(auto i = m_collectors.begin(); i != m_collectors.end(); ++i)
   {
     (*i)->sync();
@@ -488,44 +816,333 @@ MultiDevice::sync()
 
   for(auto i = m_devices.begin(); i != m_devices.end(); ++i)
   {
-    i->second->sync();
+    if (!m_lazy_devices.count(i->first)) {
+      i->second->sync();
+    } else {
+      sync_lazy_device(i->first);
+    }
+  }
+}
+
+SendStatus
+MultiDevice::try_send(uint32_t device_id, int ev_type, int ev_code, int value) noexcept
+{
+  try
+  {
+    if (!m_lazy_devices.empty() && m_lazy_devices.count(device_id))
+    {
+      send_lazy(device_id, ev_type, ev_code, value);
+      return SendStatus::OK;
+    }
+  }
+  catch (...)
+  {
+    return SendStatus::ERROR;
+  }
+
+  auto const it = m_devices.find(device_id);
+  if (it == m_devices.end()) {
+    return SendStatus::ERROR;
+  }
+
+  SendStatus status = SendStatus::OK;
+  if (ev_type == EV_REL && (ev_code == REL_WHEEL || ev_code == REL_HWHEEL))
+  {
+    int const hires_code = get_hires_mirror(device_id, ev_code);
+    if (hires_code >= 0) {
+      status = it->second->try_send(EV_REL, static_cast<uint16_t>(hires_code), value * 120);
+    }
+  }
+
+  return std::max(status, it->second->try_send(static_cast<uint16_t>(ev_type), static_cast<uint16_t>(ev_code), value));
+}
+
+SendStatus
+MultiDevice::try_sync() noexcept
+{
+  SendStatus status = SendStatus::OK;
+
+  try
+  {
+    poll_lazy_devices();
+
+    for(auto i = m_collectors.begin(); i != m_collectors.end(); ++i)
+    {
+      (*i)->sync();
+    }
+  }
+  catch (...)
+  {
+    status = SendStatus::ERROR;
+  }
+
+  for(auto i = m_devices.begin(); i != m_devices.end(); ++i)
+  {
+    if (!m_lazy_devices.count(i->first)) {
+      status = std::max(status, i->second->try_sync());
+    } else {
+      sync_lazy_device(i->first);
+    }
+  }
+
+  return status;
+}
+
+SendStatus
+MultiDevice::flush() noexcept
+{
+  SendStatus status = SendStatus::OK;
+
+  for(auto i = m_devices.begin(); i != m_devices.end(); ++i)
+  {
+    if (!m_lazy_devices.count(i->first)) {
+      status = std::max(status, i->second->flush());
+    }
+  }
+
+  return status;
+}
+
+void
+MultiDevice::send_lazy(uint32_t device_id, int ev_type, int ev_code, int value)
+{
+  LazyDevice& lazy = m_lazy_devices[device_id];
+
+  if (lazy.failed) {
+    return;
+  }
+
+  if (!lazy.creation.valid())
+  {
+    std::unique_ptr<Device>& device = m_devices[device_id];
+
+    if (adopt_pooled_device(device))
+    {
+      m_lazy_devices.erase(device_id);
+      device->send(static_cast<uint16_t>(ev_type), static_cast<uint16_t>(ev_code), value);
+      return;
+    }
+
+    uinpp_log_debug("lazily creating device: {}", device_id);
+    lazy.creation = std::async(std::launch::async, [dev = device.get()]{ dev->finish(); });
+  }
+
+  if (lazy.pending.size() >= MAX_LAZY_PENDING)
+  {
+    lazy.dropped += 1;
+    return;
+  }
+
+  lazy.pending.push_back(input_event{ {},
+                                      static_cast<uint16_t>(ev_type),
+                                      static_cast<uint16_t>(ev_code),
+                                      value });
+}
+
+void
+MultiDevice::sync_lazy_device(uint32_t device_id)
+{
+  std::vector<input_event>& pending = m_lazy_devices[device_id].pending;
+  if (!pending.empty() && pending.back().type != EV_SYN) {
+    pending.push_back(input_event{ {}, EV_SYN, SYN_REPORT, 0 });
+  }
+}
+
+void
+MultiDevice::poll_lazy_devices()
+{
+  for (auto it = m_lazy_devices.begin(); it != m_lazy_devices.end();)
+  {
+    LazyDevice& lazy = it->second;
+
+    if (!lazy.creation.valid() ||
+        lazy.creation.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+      ++it;
+      continue;
+    }
+
+    try
+    {
+      lazy.creation.get();
+    }
+    catch (std::exception const& err)
+    {
+      uinpp_log_error("failed to create device {}: {}", it->first, err.what());
+      lazy.failed = true;
+      lazy.pending.clear();
+      ++it;
+      continue;
+    }
+
+    Device* dev = get_uinput(it->first);
+    if (lazy.dropped != 0)
+    {
+      uinpp_log_warn("device {}: dropped {} events queued during creation", it->first, lazy.dropped);
+      dev->count_dropped_events(lazy.dropped);
+    }
+
+    for (auto const& ev : lazy.pending)
+    {
+      if (ev.type == EV_SYN) {
+        dev->sync();
+      } else {
+        dev->send(ev.type, ev.code, ev.value);
+      }
+    }
+
+    it = m_lazy_devices.erase(it);
   }
 }
 
 void
 MultiDevice::send_rel_repetitive(Event const& code, float value, int repeat_interval)
 {
+  uint32_t const device_id = code.get_device_id();
+  auto it = std::find_if(m_rel_repeats.begin(), m_rel_repeats.end(),
+                         [&](RelRepeat const& rel) {
+                           return rel.device_id == device_id && rel.code == code.code;
+                         });
+
   if (repeat_interval < 0)
   { // remove rel_repeats from list
-    // FIXME: should send the last value still in the repeater
-    m_rel_repeat_lst.erase(code);
-    // no need to send a event for rel, as it defaults to 0 anyway
+    if (it != m_rel_repeats.end())
+    {
+      // send what is left of the movement, rounded to the nearest unit
+      int64_t const unit = it->repeat_interval << 16;
+      int64_t const rest = (2 * it->remainder + (it->remainder < 0 ? -unit : unit)) / (2 * unit);
+      if (rest != 0) {
+        send(device_id, EV_REL, code.code, static_cast<int>(rest));
+      }
+
+      m_rel_repeats.erase(it);
+    }
   }
   else
   { // add rel_repeats to list
-    auto const it = m_rel_repeat_lst.find(code);
+    int64_t const value_q16 = std::llround(static_cast<double>(value) * 65536.0);
+
+    // an interval of 0 would mean infinite speed
+    int64_t const interval = std::max(repeat_interval, 1);
 
-    if (it == m_rel_repeat_lst.end())
+    if (it == m_rel_repeats.end())
     {
-      RelRepeat rel_rep;
-      rel_rep.code  = code;
-      rel_rep.value = value;
-      rel_rep.rest  = 0.0f;
-      rel_rep.time_count = 0;
-      rel_rep.repeat_interval = repeat_interval;
-      m_rel_repeat_lst.insert(std::pair<Event, RelRepeat>(code, rel_rep));
+      // Send the event once, the fraction carries over into the repeat
+      int64_t const first = value_q16 / 65536;
+      m_rel_repeats.push_back(RelRepeat{device_id, code.code, value_q16, interval,
+                                        (value_q16 - first * 65536) * interval});
 
-      // Send the event once
-      get_uinput(code.get_device_id())->send(EV_REL, static_cast<uint16_t>(code.code), static_cast<int32_t>(value));
+      send(device_id, EV_REL, code.code, static_cast<int>(first));
     }
     else
     {
-      // FIXME: send old value, store new value for rest
+      // keep the movement accumulated so far, rescaled to the new interval
+      it->remainder = it->remainder * interval / it->repeat_interval;
+      it->value = value_q16;
+      it->repeat_interval = interval;
+    }
+  }
+}
+
+void
+MultiDevice::send_scroll(uint32_t device_id, int code, int value)
+{
+  assert(code == REL_WHEEL || code == REL_HWHEEL);
+
+  auto it = std::find_if(m_scrolls.begin(), m_scrolls.end(),
+                         [&](Scroll const& scroll) {
+                           return scroll.device_id == device_id && scroll.code == code;
+                         });
+  if (it == m_scrolls.end()) {
+    it = m_scrolls.insert(m_scrolls.end(), Scroll{device_id, code, 0, 0, 0});
+  }
+
+  if (value == 0) {
+    return;
+  }
+
+  uint16_t const hires_code = code == REL_WHEEL ? REL_WHEEL_HI_RES : REL_HWHEEL_HI_RES;
+  if (get_uinput(device_id)->get_capabilities().has_rel(hires_code)) {
+    send_event(device_id, EV_REL, hires_code, value);
+  }
+
+  // same as the kernel's hid-input, a change of direction starts a
+  // new notch
+  if ((it->legacy_remainder < 0) != (value < 0)) {
+    it->legacy_remainder = 0;
+  }
+
+  it->legacy_remainder += value;
+  int const notches = it->legacy_remainder / 120;
+  if (notches != 0)
+  {
+    it->legacy_remainder -= notches * 120;
+    send_event(device_id, EV_REL, code, notches);
+  }
+}
+
+void
+MultiDevice::set_scroll_velocity(uint32_t device_id, int code, float notches_per_sec)
+{
+  assert(code == REL_WHEEL || code == REL_HWHEEL);
+
+  int64_t const velocity = std::llround(static_cast<double>(notches_per_sec) * 120.0 * 65536.0);
+
+  auto it = std::find_if(m_scrolls.begin(), m_scrolls.end(),
+                         [&](Scroll const& scroll) {
+                           return scroll.device_id == device_id && scroll.code == code;
+                         });
+  if (it == m_scrolls.end()) {
+    m_scrolls.push_back(Scroll{device_id, code, velocity, 0, 0});
+  } else {
+    it->velocity = velocity;
+  }
+}
+
+int
+MultiDevice::get_hires_mirror(uint32_t device_id, int ev_code) const
+{
+  if (m_hires_mirrors.empty()) {
+    return -1;
+  }
+
+  auto const it = m_hires_mirrors.find(device_id);
+  if (it == m_hires_mirrors.end()) {
+    return -1;
+  }
+
+  if (ev_code == REL_WHEEL) {
+    return it->second.wheel ? REL_WHEEL_HI_RES : -1;
+  } else {
+    return it->second.hwheel ? REL_HWHEEL_HI_RES : -1;
+  }
+}
+
+void
+MultiDevice::update_hires_mirrors()
+{
+  m_hires_mirrors.clear();
+
+  for (auto const& it : m_devices)
+  {
+    CapabilitySet const& caps = it.second->get_capabilities();
+    HiresMirror mirror{ caps.has_rel(REL_WHEEL_HI_RES), caps.has_rel(REL_HWHEEL_HI_RES) };
+
+    // the user drives the hi-res wheel with its own emitter
+    for (EventCollector const* collector : m_collectors)
+    {
+      if (collector->get_device_id() == it.first && collector->get_type() == EV_REL)
+      {
+        if (collector->get_code() == REL_WHEEL_HI_RES) {
+          mirror.wheel = false;
+        } else if (collector->get_code() == REL_HWHEEL_HI_RES) {
+          mirror.hwheel = false;
+        }
+      }
+    }
 
-      it->second.code  = code;
-      it->second.value = value;
-      // it->second.time_count = do not touch this
-      it->second.repeat_interval = repeat_interval;
+    if (mirror.wheel || mirror.hwheel) {
+      m_hires_mirrors[it.first] = mirror;
     }
   }
 }
@@ -571,6 +1188,17 @@ MultiDevice::set_device_usbid(uint32_t device_id, input_id id)
   m_device_usbids[device_id] = id;
 }
 
+void
+MultiDevice::set_device_type(uint32_t device_id, DeviceType type)
+{
+  auto const it = m_devices.find(device_id);
+  if (it != m_devices.end() && it->second->get_type() != type) {
+    throw std::runtime_error(fmt::format("set_device_type: device {} was already created", device_id));
+  }
+
+  m_device_types[device_id] = type;
+}
+
 void
 MultiDevice::set_device_usbids(const std::map<uint32_t, struct input_id>& device_usbids)
 {
@@ -583,12 +1211,61 @@ MultiDevice::set_device_names(const std::map<uint32_t, std::string>& device_name
   m_device_names = device_names;
 }
 
+void
+MultiDevice::set_device_pool(DevicePool* pool)
+{
+  m_device_pool = pool;
+}
+
+void
+MultiDevice::set_device_reaper(DeviceReaper* reaper)
+{
+  m_device_reaper = reaper;
+}
+
+void
+MultiDevice::set_backend(DeviceBackend backend)
+{
+  m_backend = backend;
+}
+
+void
+MultiDevice::set_stats_region(StatsRegion* region)
+{
+  m_stats_region = region;
+}
+
+void
+MultiDevice::set_lazy(bool lazy)
+{
+  m_lazy = lazy;
+}
+
+bool
+MultiDevice::is_device_pending(uint32_t device_id) const
+{
+  auto const it = m_lazy_devices.find(device_id);
+  return it != m_lazy_devices.end() && !it->second.failed;
+}
+
 void
 MultiDevice::set_ff_callback(int device_id, const std::function<void (uint8_t, uint8_t)>& callback)
 {
   get_uinput(device_id)->set_ff_callback(callback);
 }
 
+void
+MultiDevice::set_state_callback(uint32_t device_id, std::function<void (DeviceStateSnapshot const&)> const& callback)
+{
+  get_uinput(device_id)->set_state_callback(callback);
+}
+
+void
+MultiDevice::set_output_interval(uint32_t device_id, int msec)
+{
+  get_uinput(device_id)->set_output_interval(msec);
+}
+
 } // namespace uinpp
 
 /* EOF */
@@ -0,0 +1,269 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "multitouch.hpp"
+
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "capability_set.hpp"
+#include "multi_device.hpp"
+
+namespace uinpp {
+
+namespace {
+
+/** BTN_TOOL_* for the given number of contacts */
+int get_tool_for_count(int count)
+{
+  switch (count)
+  {
+    case 0: return -1;
+    case 1: return BTN_TOOL_FINGER;
+    case 2: return BTN_TOOL_DOUBLETAP;
+    case 3: return BTN_TOOL_TRIPLETAP;
+    case 4: return BTN_TOOL_QUADTAP;
+    default: return BTN_TOOL_QUINTTAP;
+  }
+}
+
+} // namespace
+
+Multitouch::Multitouch(MultiDevice& uinput, uint32_t device_id, DeviceType type, MultitouchConfig const& config) :
+  m_uinput(uinput),
+  m_device_id(device_id),
+  m_type(type),
+  m_num_slots(config.num_slots),
+  m_has_pressure(config.pressure_max > 0),
+  m_active(static_cast<size_t>(config.num_slots), 0),
+  m_lifted(static_cast<size_t>(config.num_slots), 0),
+  m_x(static_cast<size_t>(config.num_slots), 0),
+  m_y(static_cast<size_t>(config.num_slots), 0),
+  m_pressure(static_cast<size_t>(config.num_slots), 0),
+  m_sent_active(static_cast<size_t>(config.num_slots), 0),
+  m_sent_x(static_cast<size_t>(config.num_slots), 0),
+  m_sent_y(static_cast<size_t>(config.num_slots), 0),
+  m_sent_pressure(static_cast<size_t>(config.num_slots), 0),
+  m_sent_serial(static_cast<size_t>(config.num_slots), 0),
+  m_current_slot(0),
+  m_next_tracking_id(0),
+  m_next_serial(0),
+  m_touch(false),
+  m_tool(-1),
+  m_st_x(std::numeric_limits<int>::min()),
+  m_st_y(std::numeric_limits<int>::min()),
+  m_st_pressure(std::numeric_limits<int>::min())
+{
+  if (type != DeviceType::TOUCHPAD && type != DeviceType::TOUCHSCREEN) {
+    throw std::runtime_error("Multitouch: device type must be TOUCHPAD or TOUCHSCREEN");
+  }
+
+  if (config.num_slots < 1 || config.x_min >= config.x_max || config.y_min >= config.y_max) {
+    throw std::runtime_error(fmt::format("Multitouch: invalid config for device {}", device_id));
+  }
+
+  CapabilitySet caps;
+  caps.add_abs(ABS_MT_SLOT, 0, config.num_slots - 1);
+  caps.add_abs(ABS_MT_TRACKING_ID, 0, 65535);
+  caps.add_abs(ABS_MT_POSITION_X, config.x_min, config.x_max, 0, 0, config.resolution);
+  caps.add_abs(ABS_MT_POSITION_Y, config.y_min, config.y_max, 0, 0, config.resolution);
+  caps.add_abs(ABS_X, config.x_min, config.x_max, 0, 0, config.resolution);
+  caps.add_abs(ABS_Y, config.y_min, config.y_max, 0, 0, config.resolution);
+  if (m_has_pressure) {
+    caps.add_abs(ABS_MT_PRESSURE, 0, config.pressure_max);
+    caps.add_abs(ABS_PRESSURE, 0, config.pressure_max);
+  }
+
+  caps.add_key(BTN_TOUCH);
+  if (type == DeviceType::TOUCHPAD)
+  {
+    // the tool keys tell the number of fingers, capped by the slots
+    for (int count = 1; count <= config.num_slots && count <= 5; ++count) {
+      caps.add_key(static_cast<uint16_t>(get_tool_for_count(count)));
+    }
+  }
+
+  uinput.set_device_type(device_id, type);
+  uinput.add_capabilities(device_id, caps);
+}
+
+Multitouch::~Multitouch()
+{
+}
+
+void
+Multitouch::set_contact(int slot, int x, int y, int pressure)
+{
+  assert(slot >= 0 && slot < m_num_slots);
+
+  size_t const s = static_cast<size_t>(slot);
+  m_active[s] = 1;
+  m_x[s] = x;
+  m_y[s] = y;
+  m_pressure[s] = pressure;
+}
+
+void
+Multitouch::release_contact(int slot)
+{
+  assert(slot >= 0 && slot < m_num_slots);
+
+  size_t const s = static_cast<size_t>(slot);
+  if (m_active[s]) {
+    m_active[s] = 0;
+    m_lifted[s] = 1;
+  }
+}
+
+void
+Multitouch::release_all()
+{
+  for (int slot = 0; slot < m_num_slots; ++slot) {
+    release_contact(slot);
+  }
+}
+
+void
+Multitouch::select_slot(int slot)
+{
+  if (slot != m_current_slot)
+  {
+    m_uinput.send(m_device_id, EV_ABS, ABS_MT_SLOT, slot);
+    m_current_slot = slot;
+  }
+}
+
+void
+Multitouch::send()
+{
+  int count = 0;
+  int oldest = -1;
+
+  for (int slot = 0; slot < m_num_slots; ++slot)
+  {
+    size_t const s = static_cast<size_t>(slot);
+
+    bool const was_active = m_sent_active[s];
+    bool const is_active = m_active[s];
+
+    if (is_active && (!was_active || m_lifted[s]))
+    {
+      // new contact, a new tracking id ends the previous one in the
+      // same slot without the need for a -1 in between
+      select_slot(slot);
+      m_uinput.send(m_device_id, EV_ABS, ABS_MT_TRACKING_ID, m_next_tracking_id);
+      m_next_tracking_id = (m_next_tracking_id + 1) & 0xffff;
+      m_uinput.send(m_device_id, EV_ABS, ABS_MT_POSITION_X, m_x[s]);
+      m_uinput.send(m_device_id, EV_ABS, ABS_MT_POSITION_Y, m_y[s]);
+      if (m_has_pressure) {
+        m_uinput.send(m_device_id, EV_ABS, ABS_MT_PRESSURE, m_pressure[s]);
+      }
+      m_sent_serial[s] = m_next_serial++;
+    }
+    else if (!is_active && was_active)
+    {
+      select_slot(slot);
+      m_uinput.send(m_device_id, EV_ABS, ABS_MT_TRACKING_ID, -1);
+    }
+    else if (is_active)
+    {
+      if (m_x[s] != m_sent_x[s]) {
+        select_slot(slot);
+        m_uinput.send(m_device_id, EV_ABS, ABS_MT_POSITION_X, m_x[s]);
+      }
+
+      if (m_y[s] != m_sent_y[s]) {
+        select_slot(slot);
+        m_uinput.send(m_device_id, EV_ABS, ABS_MT_POSITION_Y, m_y[s]);
+      }
+
+      if (m_has_pressure && m_pressure[s] != m_sent_pressure[s]) {
+        select_slot(slot);
+        m_uinput.send(m_device_id, EV_ABS, ABS_MT_PRESSURE, m_pressure[s]);
+      }
+    }
+
+    m_sent_active[s] = m_active[s];
+    m_sent_x[s] = m_x[s];
+    m_sent_y[s] = m_y[s];
+    m_sent_pressure[s] = m_pressure[s];
+    m_lifted[s] = 0;
+
+    if (is_active)
+    {
+      count += 1;
+      if (oldest < 0 || m_sent_serial[s] < m_sent_serial[static_cast<size_t>(oldest)]) {
+        oldest = slot;
+      }
+    }
+  }
+
+  // single touch emulation, follows the oldest contact like the
+  // kernel's input_mt_report_pointer_emulation()
+  bool const touch = count > 0;
+  if (touch != m_touch)
+  {
+    m_uinput.send(m_device_id, EV_KEY, BTN_TOUCH, touch ? 1 : 0);
+    m_touch = touch;
+  }
+
+  if (m_type == DeviceType::TOUCHPAD)
+  {
+    int const tool = get_tool_for_count(count);
+    if (tool != m_tool)
+    {
+      if (m_tool >= 0) {
+        m_uinput.send(m_device_id, EV_KEY, m_tool, 0);
+      }
+      if (tool >= 0) {
+        m_uinput.send(m_device_id, EV_KEY, tool, 1);
+      }
+      m_tool = tool;
+    }
+  }
+
+  if (oldest >= 0)
+  {
+    size_t const s = static_cast<size_t>(oldest);
+
+    if (m_x[s] != m_st_x) {
+      m_uinput.send(m_device_id, EV_ABS, ABS_X, m_x[s]);
+      m_st_x = m_x[s];
+    }
+
+    if (m_y[s] != m_st_y) {
+      m_uinput.send(m_device_id, EV_ABS, ABS_Y, m_y[s]);
+      m_st_y = m_y[s];
+    }
+
+    if (m_has_pressure && m_pressure[s] != m_st_pressure) {
+      m_uinput.send(m_device_id, EV_ABS, ABS_PRESSURE, m_pressure[s]);
+      m_st_pressure = m_pressure[s];
+    }
+  }
+  else if (m_has_pressure && m_st_pressure != 0)
+  {
+    m_uinput.send(m_device_id, EV_ABS, ABS_PRESSURE, 0);
+    m_st_pressure = 0;
+  }
+}
+
+} // namespace uinpp
+
+/* EOF */
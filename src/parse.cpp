@@ -16,6 +16,8 @@
 
 #include "parse.hpp"
 
+#include <cerrno>
+#include <cstdlib>
 #include <limits>
 #include <sstream>
 #include <vector>
@@ -203,6 +205,32 @@ void split_event_name(std::string const& str, std::string* event_str, int* slot_
   }
 }
 
+std::vector<int> parse_int_list(std::string const& str)
+{
+  std::vector<int> values;
+  for (char const* p = str.c_str(); ; )
+  {
+    char const* const start = p;
+    char* end;
+    errno = 0;
+    long const value = strtol(start, &end, 10);
+    if (end == start || errno == ERANGE ||
+        value < std::numeric_limits<int>::min() ||
+        value > std::numeric_limits<int>::max() ||
+        (*end != ',' && *end != '\0'))
+    {
+      throw std::runtime_error(fmt::format("couldn't convert '{}' to a list of ints", str));
+    }
+
+    values.push_back(static_cast<int>(value));
+
+    if (*end == '\0') {
+      return values;
+    }
+    p = end + 1;
+  }
+}
+
 } // namespace uinpp
 
 /* EOF */
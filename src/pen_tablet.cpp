@@ -0,0 +1,213 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "pen_tablet.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "capability_set.hpp"
+#include "multi_device.hpp"
+
+namespace uinpp {
+
+namespace {
+
+/** tilt resolution in units per radian for a tilt in degree, same as
+    the wacom driver */
+constexpr int tilt_resolution = 57;
+
+/** two frames for leaving proximity and one for entering, when a
+    sample switches the tool */
+constexpr size_t max_events_per_sample = 24;
+
+uint16_t get_tool_code(PenTool tool)
+{
+  return tool == PenTool::ERASER ? BTN_TOOL_RUBBER : BTN_TOOL_PEN;
+}
+
+} // namespace
+
+PenTablet::PenTablet(MultiDevice& uinput, uint32_t device_id, PenTabletConfig const& config) :
+  m_uinput(uinput),
+  m_device_id(device_id),
+  m_has_pressure(config.pressure_max > 0),
+  m_has_tilt(config.tilt_max > 0),
+  m_has_eraser(config.has_eraser),
+  m_events(),
+  m_proximity(false),
+  m_tool(PenTool::PEN),
+  m_x(std::numeric_limits<int>::min()),
+  m_y(std::numeric_limits<int>::min()),
+  m_pressure(0),
+  m_tilt_x(std::numeric_limits<int>::min()),
+  m_tilt_y(std::numeric_limits<int>::min()),
+  m_touch(false),
+  m_stylus(false),
+  m_stylus2(false)
+{
+  if (config.x_max <= 0 || config.y_max <= 0 || config.resolution < 0 ||
+      config.pressure_max < 0 || config.tilt_max < 0)
+  {
+    throw std::runtime_error(fmt::format("PenTablet: invalid config for device {}", device_id));
+  }
+
+  CapabilitySet caps;
+  caps.add_prop(config.direct ? INPUT_PROP_DIRECT : INPUT_PROP_POINTER);
+  caps.add_abs(ABS_X, 0, config.x_max, 0, 0, config.resolution);
+  caps.add_abs(ABS_Y, 0, config.y_max, 0, 0, config.resolution);
+  if (m_has_pressure) {
+    caps.add_abs(ABS_PRESSURE, 0, config.pressure_max);
+  }
+  if (m_has_tilt) {
+    caps.add_abs(ABS_TILT_X, -config.tilt_max, config.tilt_max, 0, 0, tilt_resolution);
+    caps.add_abs(ABS_TILT_Y, -config.tilt_max, config.tilt_max, 0, 0, tilt_resolution);
+  }
+
+  caps.add_key(BTN_TOOL_PEN);
+  if (m_has_eraser) {
+    caps.add_key(BTN_TOOL_RUBBER);
+  }
+  caps.add_key(BTN_TOUCH);
+  caps.add_key(BTN_STYLUS);
+  caps.add_key(BTN_STYLUS2);
+
+  uinput.set_device_type(device_id, DeviceType::TABLET);
+  uinput.add_capabilities(device_id, caps);
+
+  m_events.reserve(max_events_per_sample);
+}
+
+PenTablet::~PenTablet()
+{
+}
+
+void
+PenTablet::send(PenSample const& sample)
+{
+  send_batch(std::span<PenSample const>(&sample, 1));
+}
+
+void
+PenTablet::send_batch(std::span<PenSample const> samples)
+{
+  m_events.clear();
+
+  for (PenSample const& sample : samples) {
+    append_sample(sample);
+  }
+
+  if (!m_events.empty()) {
+    m_uinput.send_events(m_device_id, m_events);
+  }
+}
+
+void
+PenTablet::append_sample(PenSample const& sample)
+{
+  PenTool const tool = (sample.tool == PenTool::ERASER && m_has_eraser) ? PenTool::ERASER : PenTool::PEN;
+
+  if (m_proximity && (!sample.proximity || tool != m_tool)) {
+    append_leave();
+  }
+
+  if (!sample.proximity) {
+    return;
+  }
+
+  size_t const frame_start = m_events.size();
+
+  append_abs(ABS_X, sample.x, m_x);
+  append_abs(ABS_Y, sample.y, m_y);
+  if (m_has_pressure) {
+    append_abs(ABS_PRESSURE, std::max(sample.pressure, 0), m_pressure);
+  }
+  if (m_has_tilt) {
+    append_abs(ABS_TILT_X, sample.tilt_x, m_tilt_x);
+    append_abs(ABS_TILT_Y, sample.tilt_y, m_tilt_y);
+  }
+
+  if (!m_proximity)
+  {
+    m_proximity = true;
+    m_tool = tool;
+    append(EV_KEY, get_tool_code(tool), 1);
+  }
+
+  append_key(BTN_TOUCH, sample.pressure > 0, m_touch);
+  append_key(BTN_STYLUS, sample.buttons & PEN_BUTTON_STYLUS, m_stylus);
+  append_key(BTN_STYLUS2, sample.buttons & PEN_BUTTON_STYLUS2, m_stylus2);
+
+  if (m_events.size() != frame_start) {
+    append(EV_SYN, SYN_REPORT, 0);
+  }
+}
+
+void
+PenTablet::append_leave()
+{
+  size_t const frame_start = m_events.size();
+
+  if (m_has_pressure) {
+    append_abs(ABS_PRESSURE, 0, m_pressure);
+  }
+  append_key(BTN_TOUCH, false, m_touch);
+  append_key(BTN_STYLUS, false, m_stylus);
+  append_key(BTN_STYLUS2, false, m_stylus2);
+
+  if (m_events.size() != frame_start) {
+    append(EV_SYN, SYN_REPORT, 0);
+  }
+
+  append(EV_KEY, get_tool_code(m_tool), 0);
+  append(EV_SYN, SYN_REPORT, 0);
+  m_proximity = false;
+}
+
+void
+PenTablet::append_abs(uint16_t code, int value, int& sent)
+{
+  if (value != sent)
+  {
+    append(EV_ABS, code, value);
+    sent = value;
+  }
+}
+
+void
+PenTablet::append_key(uint16_t code, bool value, bool& sent)
+{
+  if (value != sent)
+  {
+    append(EV_KEY, code, value ? 1 : 0);
+    sent = value;
+  }
+}
+
+void
+PenTablet::append(uint16_t type, uint16_t code, int value)
+{
+  // the timestamp is left empty as the kernel stamps the events itself
+  m_events.push_back(input_event{ {}, type, code, value });
+}
+
+} // namespace uinpp
+
+/* EOF */
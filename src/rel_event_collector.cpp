@@ -16,32 +16,107 @@
 
 #include "rel_event_collector.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
 #include "multi_device.hpp"
 
 namespace uinpp {
 
-RelEventCollector::RelEventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code) :
-  EventCollector(uinput, device_id, type, code),
-  m_emitters()
+RelEventCollector::RelEventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code) :
+  EventCollector(uinput, arena, device_id, type, code, MergePolicy::SUM),
+  m_emitters(&arena),
+  m_last_writer(nullptr),
+  m_dirty(false)
 {
 }
 
 EventEmitter*
 RelEventCollector::create_emitter()
 {
-  m_emitters.emplace_back(std::make_unique<RelEventEmitter>(*this));
+  m_emitters.emplace_back(m_arena.create<RelEventEmitter>(*this));
   return m_emitters.back().get();
 }
 
 void
-RelEventCollector::send(int value)
+RelEventCollector::send(RelEventEmitter const& emitter)
+{
+  m_last_writer = &emitter;
+  m_dirty = true;
+}
+
+int
+RelEventCollector::merge() const
 {
-  m_uinput.send(get_device_id(), get_type(), get_code(), value);
+  switch (m_merge_policy)
+  {
+    case MergePolicy::MAX_MAGNITUDE:
+      {
+        int value = 0;
+        for (auto const& emitter : m_emitters)
+        {
+          if (std::abs(int64_t{emitter->get_value()}) > std::abs(int64_t{value})) {
+            value = emitter->get_value();
+          }
+        }
+        return value;
+      }
+
+    case MergePolicy::PRIORITY:
+      for (auto const& emitter : m_emitters)
+      {
+        if (emitter->get_value() != 0) {
+          return emitter->get_value();
+        }
+      }
+      return 0;
+
+    case MergePolicy::LAST_WRITER:
+      return m_last_writer->get_value();
+
+    case MergePolicy::SUM:
+    default:
+      {
+        int64_t value = 0;
+        for (auto const& emitter : m_emitters) {
+          value += emitter->get_value();
+        }
+        return static_cast<int>(std::clamp(value,
+                                           int64_t{std::numeric_limits<int>::min()},
+                                           int64_t{std::numeric_limits<int>::max()}));
+      }
+  }
 }
 
 void
 RelEventCollector::sync()
 {
+  if (!m_dirty) {
+    return;
+  }
+
+  int const value = merge();
+  reset();
+
+  if (value != 0) {
+    m_uinput.send(get_device_id(), get_type(), get_code(), value);
+  }
+}
+
+void
+RelEventCollector::reset()
+{
+  for (auto const& emitter : m_emitters) {
+    emitter->clear();
+  }
+  m_dirty = false;
+}
+
+bool
+RelEventCollector::supports_merge_policy(MergePolicy policy) const
+{
+  return policy != MergePolicy::OR;
 }
 
 } // namespace uinpp
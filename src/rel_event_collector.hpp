@@ -25,15 +25,27 @@ namespace uinpp {
 class RelEventCollector : public EventCollector
 {
 public:
-  RelEventCollector(MultiDevice& uinput, uint32_t device_id, int type, int code);
+  RelEventCollector(MultiDevice& uinput, Arena& arena, uint32_t device_id, int type, int code);
 
   EventEmitter* create_emitter() override;
+  std::size_t get_emitter_count() const override { return m_emitters.size(); }
   void sync() override;
+  void reset() override;
 
-  void send(int value);
+  /** \a emitter moved, merged on the next sync() */
+  void send(RelEventEmitter const& emitter);
+
+protected:
+  bool supports_merge_policy(MergePolicy policy) const override;
+
+private:
+  int merge() const;
 
 private:
-  std::vector<std::unique_ptr<RelEventEmitter>> m_emitters;
+  std::pmr::vector<ArenaPtr<RelEventEmitter>> m_emitters;
+
+  RelEventEmitter const* m_last_writer;
+  bool m_dirty;
 
 private:
   RelEventCollector(RelEventCollector const&);
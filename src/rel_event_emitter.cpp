@@ -21,14 +21,16 @@
 namespace uinpp {
 
 RelEventEmitter::RelEventEmitter(RelEventCollector& collector) :
-  m_collector(collector)
+  m_collector(collector),
+  m_value(0)
 {
 }
 
 void
 RelEventEmitter::send(int value)
 {
-  m_collector.send(value);
+  m_value += value;
+  m_collector.send(*this);
 }
 
 } // namespace uinpp
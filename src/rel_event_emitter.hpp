@@ -28,11 +28,17 @@ class RelEventEmitter : public EventEmitter
 private:
   RelEventCollector& m_collector;
 
+  /** movement since the last sync() */
+  int m_value;
+
 public:
   RelEventEmitter(RelEventCollector& collector);
 
   void send(int value) override;
 
+  int get_value() const { return m_value; }
+  void clear() { m_value = 0; }
+
 private:
   RelEventEmitter(RelEventEmitter const&);
   RelEventEmitter& operator=(RelEventEmitter const&);
@@ -0,0 +1,159 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stats_region.hpp"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace uinpp {
+
+static_assert(sizeof(StatsRegion::Layout) <= 64 * 1024, "stats region should stay small");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "stats are shared across processes and need lock-free atomics");
+
+std::string
+StatsRegion::get_default_name(pid_t pid)
+{
+  return fmt::format("/uinpp-{}", pid);
+}
+
+std::unique_ptr<StatsRegion>
+StatsRegion::create(std::string const& name)
+{
+  int const fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error(fmt::format("shm_open({}) failed: {}", name, strerror(errno)));
+  }
+
+  if (ftruncate(fd, sizeof(Layout)) < 0)
+  {
+    int const err = errno;
+    ::close(fd);
+    shm_unlink(name.c_str());
+    throw std::runtime_error(fmt::format("ftruncate({}) failed: {}", name, strerror(err)));
+  }
+
+  void* ptr = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int const err = errno;
+  ::close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    shm_unlink(name.c_str());
+    throw std::runtime_error(fmt::format("mmap({}) failed: {}", name, strerror(err)));
+  }
+
+  Layout* layout = new (ptr) Layout();
+  layout->version = VERSION;
+  layout->size = sizeof(Layout);
+  layout->pid = getpid();
+  std::atomic_thread_fence(std::memory_order_release);
+  layout->magic = MAGIC;
+
+  return std::unique_ptr<StatsRegion>(new StatsRegion(name, layout, true));
+}
+
+std::unique_ptr<StatsRegion>
+StatsRegion::open(std::string const& name)
+{
+  int const fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0) {
+    throw std::runtime_error(fmt::format("shm_open({}) failed: {}", name, strerror(errno)));
+  }
+
+  void* ptr = mmap(nullptr, sizeof(Layout), PROT_READ, MAP_SHARED, fd, 0);
+  int const err = errno;
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    throw std::runtime_error(fmt::format("mmap({}) failed: {}", name, strerror(err)));
+  }
+
+  Layout* layout = static_cast<Layout*>(ptr);
+  if (layout->magic != MAGIC ||
+      layout->version != VERSION ||
+      layout->size != sizeof(Layout))
+  {
+    munmap(ptr, sizeof(Layout));
+    throw std::runtime_error(fmt::format("{}: not a uinpp stats region or version mismatch", name));
+  }
+
+  return std::unique_ptr<StatsRegion>(new StatsRegion(name, layout, false));
+}
+
+StatsRegion::StatsRegion(std::string const& name, Layout* layout, bool owner) :
+  m_name(name),
+  m_layout(layout),
+  m_owner(owner)
+{
+}
+
+StatsRegion::~StatsRegion()
+{
+  if (m_owner) {
+    std::destroy_at(m_layout);
+    shm_unlink(m_name.c_str());
+  }
+  munmap(m_layout, sizeof(Layout));
+}
+
+DeviceStats*
+StatsRegion::acquire(uint32_t device_id, std::string_view name)
+{
+  if (!m_owner) {
+    throw std::runtime_error("StatsRegion: can't acquire slots in a read-only region");
+  }
+
+  for (Slot& slot : m_layout->slots)
+  {
+    uint32_t expected = 0;
+    if (slot.in_use.compare_exchange_strong(expected, 2, std::memory_order_acquire))
+    {
+      // 2 marks the slot as taken, but not yet filled in
+      slot.device_id = device_id;
+      size_t const len = std::min(name.size(), sizeof(slot.name) - 1);
+      std::copy_n(name.data(), len, slot.name);
+      slot.name[len] = '\0';
+      slot.stats.reset();
+      slot.in_use.store(1, std::memory_order_release);
+      return &slot.stats;
+    }
+  }
+
+  return nullptr;
+}
+
+void
+StatsRegion::release(DeviceStats* stats)
+{
+  for (Slot& slot : m_layout->slots)
+  {
+    if (&slot.stats == stats) {
+      slot.in_use.store(0, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+} // namespace uinpp
+
+/* EOF */
@@ -0,0 +1,143 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+#include <fmt/format.h>
+
+namespace uinpp {
+
+char const*
+to_string(TracePhase phase)
+{
+  switch (phase)
+  {
+    case TracePhase::SEND: return "send";
+    case TracePhase::SYNC: return "sync";
+    case TracePhase::WRITE: return "write";
+    case TracePhase::FLUSH: return "flush";
+    case TracePhase::READ: return "read";
+    case TracePhase::UPDATE: return "update";
+    default: return "unknown";
+  }
+}
+
+TraceRing::TraceRing() :
+  m_enabled(false),
+  m_head(0),
+  m_tail(0),
+  m_slots()
+{
+}
+
+void
+TraceRing::record(uint32_t device, TracePhase phase,
+                  uint16_t type, uint16_t code, int32_t value) noexcept
+{
+  uint64_t const timestamp = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+
+  uint64_t const idx = m_head.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = m_slots[idx & (CAPACITY - 1)];
+
+  slot.seq.store(2 * idx + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.timestamp.store(timestamp, std::memory_order_relaxed);
+  slot.device_phase.store((uint64_t{device} << 8) | static_cast<uint8_t>(phase),
+                          std::memory_order_relaxed);
+  slot.event.store((uint64_t{type} << 48) |
+                   (uint64_t{code} << 32) |
+                   static_cast<uint32_t>(value),
+                   std::memory_order_relaxed);
+
+  slot.seq.store(2 * idx + 2, std::memory_order_release);
+}
+
+std::vector<TraceRecord>
+TraceRing::snapshot() const
+{
+  uint64_t const head = m_head.load(std::memory_order_acquire);
+  uint64_t const tail = std::max(m_tail.load(std::memory_order_relaxed),
+                                 head > CAPACITY ? head - CAPACITY : 0);
+
+  std::vector<TraceRecord> records;
+  records.reserve(static_cast<std::size_t>(head - tail));
+
+  for (uint64_t idx = tail; idx < head; ++idx)
+  {
+    Slot const& slot = m_slots[idx & (CAPACITY - 1)];
+
+    if (slot.seq.load(std::memory_order_acquire) != 2 * idx + 2) {
+      // still being written or already overwritten
+      continue;
+    }
+
+    uint64_t const timestamp = slot.timestamp.load(std::memory_order_relaxed);
+    uint64_t const device_phase = slot.device_phase.load(std::memory_order_relaxed);
+    uint64_t const event = slot.event.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != 2 * idx + 2) {
+      continue;
+    }
+
+    records.push_back(TraceRecord{
+        timestamp,
+        static_cast<uint32_t>(device_phase >> 8),
+        static_cast<TracePhase>(device_phase & 0xff),
+        static_cast<uint16_t>(event >> 48),
+        static_cast<uint16_t>(event >> 32),
+        static_cast<int32_t>(static_cast<uint32_t>(event))
+      });
+  }
+
+  return records;
+}
+
+void
+TraceRing::dump(std::ostream& out) const
+{
+  for (TraceRecord const& rec : snapshot())
+  {
+    out << fmt::format("{}.{:09} {:#x} {} {} {} {}\n",
+                       rec.timestamp / 1000000000, rec.timestamp % 1000000000,
+                       rec.device, to_string(rec.phase),
+                       rec.type, rec.code, rec.value);
+  }
+}
+
+void
+TraceRing::clear()
+{
+  m_tail.store(m_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+TraceRing&
+get_trace_ring()
+{
+  static TraceRing ring;
+  return ring;
+}
+
+} // namespace uinpp
+
+/* EOF */
@@ -0,0 +1,90 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_UINPP_LOOPBACK_READER_HPP
+#define HEADER_UINPP_LOOPBACK_READER_HPP
+
+#include <gtest/gtest.h>
+
+#include <linux/input.h>
+#include <ostream>
+#include <span>
+#include <unistd.h>
+#include <vector>
+
+/** Helpers for tests that look at what a LOOPBACK device wrote, the
+    loopback socket is non-blocking, so reading stops once it is
+    drained */
+namespace uinpp_test {
+
+/** an input_event without the timestamp */
+struct Ev
+{
+  int type;
+  int code;
+  int value;
+
+  bool operator==(Ev const&) const = default;
+};
+
+inline std::ostream& operator<<(std::ostream& os, Ev const& ev)
+{
+  return os << "{" << ev.type << ", " << ev.code << ", " << ev.value << "}";
+}
+
+/** everything written to the loopback \a fd since the last call,
+    including the EV_SYN events */
+inline std::vector<input_event> read_loopback(int fd)
+{
+  std::vector<input_event> events;
+  input_event ev;
+  while (::read(fd, &ev, sizeof(ev)) == sizeof(ev)) {
+    events.push_back(ev);
+  }
+  return events;
+}
+
+/** read_loopback() as Ev */
+inline std::vector<Ev> read_loopback_evs(int fd)
+{
+  std::vector<Ev> events;
+  for (input_event const& ev : read_loopback(fd)) {
+    events.emplace_back(Ev{ev.type, ev.code, ev.value});
+  }
+  return events;
+}
+
+/** \a events without the EV_SYN events */
+inline std::vector<Ev> without_syn(std::vector<Ev> events)
+{
+  std::erase_if(events, [](Ev const& ev) { return ev.type == EV_SYN; });
+  return events;
+}
+
+/** hand \a events to the device behind the loopback \a fd as if the
+    host had written them */
+inline void write_loopback(int fd, std::span<input_event const> events)
+{
+  ssize_t const len = static_cast<ssize_t>(events.size_bytes());
+  ASSERT_EQ(::write(fd, events.data(), events.size_bytes()), len);
+}
+
+} // namespace uinpp_test
+
+#endif
+
+/* EOF */
@@ -0,0 +1,164 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+#include "device.hpp"
+#include "event_emitter.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+#include "trace.hpp"
+
+namespace {
+
+std::atomic<bool> g_count_allocations = false;
+std::atomic<int> g_allocation_count = 0;
+
+/** Counts the heap allocations that happen during its lifetime */
+class AllocationCounter
+{
+public:
+  AllocationCounter()
+  {
+    g_allocation_count = 0;
+    g_count_allocations = true;
+  }
+
+  ~AllocationCounter()
+  {
+    g_count_allocations = false;
+  }
+
+  int get_count() const { return g_allocation_count; }
+};
+
+} // namespace
+
+namespace {
+
+/** All replaced operator new and delete go through these two, kept
+    out of line so that the compiler pairs malloc() with free() and
+    doesn't see free() called on the result of operator new */
+[[gnu::noinline]] void* counted_alloc(std::size_t size, std::size_t alignment) noexcept
+{
+  if (g_count_allocations) {
+    g_allocation_count += 1;
+  }
+
+  size = size ? size : 1;
+  if (alignment <= alignof(std::max_align_t)) {
+    return std::malloc(size);
+  }
+
+  // aligned_alloc() wants a multiple of the alignment
+  return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] void counted_free(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void* counted_alloc_or_throw(std::size_t size, std::size_t alignment)
+{
+  if (void* ptr = counted_alloc(size, alignment)) {
+    return ptr;
+  }
+
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return counted_alloc_or_throw(size, 0); }
+void* operator new[](std::size_t size) { return counted_alloc_or_throw(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align) { return counted_alloc_or_throw(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return counted_alloc_or_throw(size, static_cast<std::size_t>(align)); }
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return counted_alloc(size, 0); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return counted_alloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align, std::nothrow_t const&) noexcept { return counted_alloc(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align, std::nothrow_t const&) noexcept { return counted_alloc(size, static_cast<std::size_t>(align)); }
+
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::nothrow_t const&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, std::nothrow_t const&) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, std::nothrow_t const&) noexcept { counted_free(ptr); }
+
+TEST(AllocationTest, steady_state_is_allocation_free)
+{
+  uint32_t const joystick_id = uinpp::create_device_id(0, uinpp::DEVICEID_JOYSTICK);
+  uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+
+  uinpp::EventEmitter* btn_a = uinput.add_key(joystick_id, BTN_A);
+  uinpp::EventEmitter* btn_a2 = uinput.add_key(joystick_id, BTN_A);
+  uinpp::EventEmitter* abs_x = uinput.add_abs(joystick_id, ABS_X, -32768, 32767, 0, 0, 0);
+  uinpp::EventEmitter* rel_x = uinput.add_rel(mouse_id, REL_X);
+  uinput.add_ff(joystick_id, FF_RUMBLE);
+  uinput.finish();
+
+  uinpp::Event rel_y = uinpp::Event::create(uinpp::DEVICEID_MOUSE, EV_REL, REL_Y);
+  rel_y.resolve_device_id(0, true);
+  uinput.send_rel_repetitive(rel_y, 2.5f, 10);
+
+  std::vector<uinpp::Device*> const devices = uinput.get_devices();
+
+  // tracing is meant to stay enabled in production
+  uinpp::get_trace_ring().enable(true);
+
+  AllocationCounter counter;
+  for (int i = 0; i < 10000; ++i)
+  {
+    btn_a->send(i % 2);
+    btn_a2->send((i / 2) % 2);
+    abs_x->send(i % 1000);
+    rel_x->send(i % 3 - 1);
+    uinput.sync();
+    uinput.update(1);
+
+    for (uinpp::Device* device : devices)
+    {
+      device->read();
+
+      // drain the loopback so that writes don't end up in the retry queue
+      char buf[4096];
+      while (::read(device->get_loopback_fd(), buf, sizeof(buf)) > 0) {}
+    }
+  }
+
+  uinpp::get_trace_ring().enable(false);
+
+  EXPECT_EQ(counter.get_count(), 0);
+}
+
+/* EOF */
@@ -0,0 +1,185 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdlib>
+
+#include "axis_processor.hpp"
+#include "device.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+/** remembers the last value it was send */
+class ValueEmitter : public uinpp::EventEmitter
+{
+public:
+  void send(int value) override { m_value = value; }
+  int m_value = 0;
+};
+
+int process_one(uinpp::AxisProcessor& processor, int value)
+{
+  std::array<int, 1> const in = { value };
+  std::array<int, 1> out = { 0 };
+  processor.process(in, out);
+  return out[0];
+}
+
+} // namespace
+
+TEST(AxisProcessorTest, identity_is_exact)
+{
+  uinpp::AxisProcessor processor;
+  processor.add_axis(nullptr, 0, 255, uinpp::AxisConfig{0, 255});
+
+  for (int v = 0; v <= 255; ++v) {
+    EXPECT_EQ(process_one(processor, v), v);
+  }
+
+  // out of range values are clamped
+  EXPECT_EQ(process_one(processor, -10), 0);
+  EXPECT_EQ(process_one(processor, 1000), 255);
+}
+
+TEST(AxisProcessorTest, rescale_and_invert)
+{
+  uinpp::AxisProcessor processor;
+  processor.add_axis(nullptr, -32768, 32767, uinpp::AxisConfig{0, 255});
+  processor.add_axis(nullptr, 0, 1023, uinpp::AxisConfig{.in_min = -32768, .in_max = 32767, .invert = true});
+
+  std::array<int, 2> const in_min = { 0, -32768 };
+  std::array<int, 2> const in_max = { 255, 32767 };
+  std::array<int, 2> out = {};
+
+  processor.process(in_min, out);
+  EXPECT_EQ(out[0], -32768);
+  EXPECT_EQ(out[1], 1023);
+
+  processor.process(in_max, out);
+  EXPECT_EQ(out[0], 32767);
+  EXPECT_EQ(out[1], 0);
+
+  // interpolated large range stays monotonic
+  int last = 1024;
+  for (int v = -32768; v <= 32767; v += 7) {
+    std::array<int, 2> const in = { 0, v };
+    processor.process(in, out);
+    EXPECT_LE(out[1], last);
+    last = out[1];
+  }
+}
+
+TEST(AxisProcessorTest, deadzone_and_curve)
+{
+  uinpp::AxisProcessor processor;
+  processor.add_axis(nullptr, -1000, 1000,
+                     uinpp::AxisConfig{.in_min = -1000, .in_max = 1000, .deadzone = 0.2f, .curve = 2.0f});
+
+  EXPECT_EQ(process_one(processor, 0), 0);
+  EXPECT_EQ(process_one(processor, 199), 0);
+  EXPECT_EQ(process_one(processor, -199), 0);
+  EXPECT_EQ(process_one(processor, 1000), 1000);
+  EXPECT_EQ(process_one(processor, -1000), -1000);
+
+  // halfway out of the deadzone, squared
+  EXPECT_NEAR(process_one(processor, 600), 250, 1);
+  EXPECT_NEAR(process_one(processor, -600), -250, 1);
+}
+
+TEST(AxisProcessorTest, trigger)
+{
+  uinpp::AxisProcessor processor;
+  processor.add_axis(nullptr, 0, 255,
+                     uinpp::AxisConfig{.in_min = 0, .in_max = 1023, .centered = false, .deadzone = 0.1f});
+
+  EXPECT_EQ(process_one(processor, 0), 0);
+  EXPECT_EQ(process_one(processor, 100), 0);
+  EXPECT_EQ(process_one(processor, 1023), 255);
+  EXPECT_NEAR(process_one(processor, 563), 128, 1);
+}
+
+TEST(AxisProcessorTest, radial_deadzone)
+{
+  uinpp::AxisProcessor processor;
+  int const x = processor.add_axis(nullptr, -32767, 32767, uinpp::AxisConfig{-32767, 32767});
+  int const y = processor.add_axis(nullptr, -32767, 32767, uinpp::AxisConfig{-32767, 32767});
+  processor.add_radial_pair(x, y, 0.25f);
+
+  std::array<int, 2> out = {};
+
+  // inside the circle, although an axial deadzone would pass it
+  processor.process(std::array<int, 2>{ 5000, 5000 }, out);
+  EXPECT_EQ(out[0], 0);
+  EXPECT_EQ(out[1], 0);
+
+  // on the diagonal the direction is preserved
+  processor.process(std::array<int, 2>{ 16000, 16000 }, out);
+  EXPECT_GT(out[0], 0);
+  EXPECT_EQ(out[0], out[1]);
+
+  // full deflection along an axis stays full
+  processor.process(std::array<int, 2>{ 32767, 0 }, out);
+  EXPECT_NEAR(out[0], 32767, 16);
+  EXPECT_EQ(out[1], 0);
+
+  // halfway out of the deadzone along the axis
+  processor.process(std::array<int, 2>{ 0, -20479 }, out);
+  EXPECT_EQ(out[0], 0);
+  EXPECT_NEAR(out[1], -16383, 64);
+}
+
+TEST(AxisProcessorTest, send_to_emitters)
+{
+  ValueEmitter emitter;
+  uinpp::AxisProcessor processor;
+  processor.add_axis(&emitter, 0, 100, uinpp::AxisConfig{0, 100});
+
+  processor.send(std::array<int, 1>{ 42 });
+  EXPECT_EQ(emitter.m_value, 42);
+}
+
+TEST(AxisProcessorTest, multi_device_axis)
+{
+  uint32_t const joystick_id = uinpp::create_device_id(0, uinpp::DEVICEID_JOYSTICK);
+
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinput.add_abs(joystick_id, ABS_X, 0, 255, 0, 0, 0);
+
+  uinpp::AxisProcessor processor;
+  processor.add_axis(uinput, joystick_id, ABS_X, uinpp::AxisConfig{.in_min = -32768, .in_max = 32767, .invert = true});
+  EXPECT_THROW(processor.add_axis(uinput, joystick_id, ABS_Y, uinpp::AxisConfig{}), std::runtime_error);
+  uinput.finish();
+
+  processor.send(std::array<int, 1>{ -32768 });
+  uinput.sync();
+
+  int value = -1;
+  for (input_event const& ev : uinpp_test::read_loopback(uinput.get_devices().front()->get_loopback_fd())) {
+    if (ev.type == EV_ABS && ev.code == ABS_X) {
+      value = ev.value;
+    }
+  }
+  EXPECT_EQ(value, 255);
+}
+
+/* EOF */
@@ -0,0 +1,119 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <unordered_set>
+
+#include "capability_set.hpp"
+#include "device.hpp"
+
+TEST(CapabilitySetTest, equality_and_hash)
+{
+  uinpp::CapabilitySet lhs;
+  lhs.add_key(BTN_A);
+  lhs.add_rel(REL_X);
+  lhs.add_abs(ABS_X, -32768, 32767);
+
+  uinpp::CapabilitySet rhs;
+  rhs.add_abs(ABS_X, -32768, 32767);
+  rhs.add_rel(REL_X);
+  rhs.add_key(BTN_A);
+
+  EXPECT_EQ(lhs, rhs);
+  EXPECT_EQ(lhs.hash(), rhs.hash());
+
+  // same axes, different range
+  rhs.add_abs(ABS_X, -1, 1);
+  EXPECT_NE(lhs, rhs);
+
+  rhs.add_abs(ABS_X, -32768, 32767);
+  rhs.add_key(BTN_B);
+  EXPECT_NE(lhs, rhs);
+
+  std::unordered_set<uinpp::CapabilitySet> set{lhs, rhs};
+  EXPECT_EQ(set.size(), 2u);
+  EXPECT_EQ(set.count(lhs), 1u);
+}
+
+TEST(CapabilitySetTest, empty)
+{
+  uinpp::CapabilitySet caps;
+  EXPECT_TRUE(caps.empty());
+
+  caps.add_prop(INPUT_PROP_POINTER);
+  EXPECT_FALSE(caps.empty());
+  EXPECT_FALSE(caps.has_keys());
+}
+
+TEST(CapabilitySetTest, out_of_range)
+{
+  uinpp::CapabilitySet caps;
+  EXPECT_THROW(caps.add_key(KEY_CNT), std::out_of_range);
+  EXPECT_THROW(caps.add_rel(REL_CNT), std::out_of_range);
+  EXPECT_FALSE(caps.has_key(KEY_CNT));
+  EXPECT_TRUE(caps.empty());
+}
+
+TEST(CapabilitySetTest, merge)
+{
+  uinpp::CapabilitySet lhs;
+  lhs.add_key(BTN_A);
+  lhs.add_abs(ABS_X, -1, 1);
+  lhs.add_abs(ABS_Z, 0, 255);
+
+  uinpp::CapabilitySet rhs;
+  rhs.add_key(BTN_B);
+  rhs.add_abs(ABS_X, -32768, 32767);
+  rhs.add_abs(ABS_Y, -32768, 32767);
+
+  lhs |= rhs;
+  EXPECT_TRUE(lhs.has_key(BTN_A));
+  EXPECT_TRUE(lhs.has_key(BTN_B));
+
+  // the absinfo of rhs wins, the axes stay sorted
+  ASSERT_EQ(lhs.get_abs_setup().size(), 3u);
+  EXPECT_EQ(lhs.get_abs_setup()[0].code, ABS_X);
+  EXPECT_EQ(lhs.get_abs_setup()[1].code, ABS_Y);
+  EXPECT_EQ(lhs.get_abs_setup()[2].code, ABS_Z);
+  EXPECT_EQ(lhs.get_absinfo(ABS_X)->minimum, -32768);
+  EXPECT_EQ(lhs.get_absinfo(ABS_Z)->maximum, 255);
+}
+
+TEST(CapabilitySetTest, device_keeps_existing_absinfo)
+{
+  uinpp::Device device(uinpp::DeviceType::GENERIC, "test", input_id{ BUS_VIRTUAL, 0, 0, 0 });
+  device.set_backend(uinpp::DeviceBackend::NONE);
+  device.add_abs(ABS_X, -1, 1);
+
+  uinpp::CapabilitySet caps;
+  caps.add_abs(ABS_X, -32768, 32767);
+  caps.add_abs(ABS_Y, -32768, 32767);
+  caps.add_key(BTN_A);
+  device.add_capabilities(caps);
+
+  // an axis that is already registered is not changed
+  device.add_abs(ABS_Y, 0, 1);
+
+  uinpp::CapabilitySet const& result = device.get_capabilities();
+  EXPECT_EQ(result.get_absinfo(ABS_X)->minimum, -1);
+  EXPECT_EQ(result.get_absinfo(ABS_Y)->minimum, -32768);
+  EXPECT_TRUE(result.has_key(BTN_A));
+}
+
+/* EOF */
@@ -0,0 +1,125 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "device.hpp"
+#include "linux.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+/** Temporary directory that is removed again with its content */
+class TempDir
+{
+public:
+  TempDir() :
+    m_path()
+  {
+    char tmpl[] = "/tmp/uinpp-test-XXXXXX";
+    if (mkdtemp(tmpl) == nullptr) {
+      throw std::runtime_error("mkdtemp() failed");
+    }
+    m_path = tmpl;
+  }
+
+  ~TempDir()
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(m_path, ec);
+  }
+
+  std::string const& get_path() const { return m_path; }
+
+private:
+  std::string m_path;
+};
+
+void touch(std::string const& path)
+{
+  int const fd = open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0644);
+  ASSERT_GE(fd, 0);
+  close(fd);
+}
+
+} // namespace
+
+TEST(DeviceNodeTest, sysname_needs_uinput)
+{
+  for (auto backend : { uinpp::DeviceBackend::NONE, uinpp::DeviceBackend::LOOPBACK })
+  {
+    uinpp::Device device(uinpp::DeviceType::GENERIC, "test", input_id{ BUS_VIRTUAL, 0, 0, 0 });
+    device.set_backend(backend);
+    device.add_key(KEY_A);
+    device.finish();
+
+    // neither fd is a uinput device that could answer UI_GET_SYSNAME
+    EXPECT_THROW(device.get_sysname(), std::runtime_error);
+    EXPECT_THROW(device.get_syspath(), std::runtime_error);
+    EXPECT_THROW(device.get_evdev_path(), std::runtime_error);
+  }
+}
+
+TEST(DeviceNodeTest, wait_for_existing_node)
+{
+  TempDir dir;
+  std::string const path = dir.get_path() + "/event0";
+  touch(path);
+
+  EXPECT_TRUE(uinpp::wait_for_device_node(path, 0ms));
+}
+
+TEST(DeviceNodeTest, wait_for_node_timeout)
+{
+  TempDir dir;
+
+  auto const start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(uinpp::wait_for_device_node(dir.get_path() + "/event0", 20ms));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+}
+
+TEST(DeviceNodeTest, wait_for_created_node)
+{
+  TempDir dir;
+  std::string const path = dir.get_path() + "/event0";
+
+  std::thread creator([&path]{
+    std::this_thread::sleep_for(20ms);
+    touch(path);
+  });
+  bool const ready = uinpp::wait_for_device_node(path, 5s);
+  creator.join();
+
+  EXPECT_TRUE(ready);
+}
+
+TEST(DeviceNodeTest, wait_for_node_in_missing_directory)
+{
+  EXPECT_THROW(uinpp::wait_for_device_node("/nonexistent-uinpp-dir/event0", 10ms), std::runtime_error);
+}
+
+/* EOF */
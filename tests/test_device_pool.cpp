@@ -0,0 +1,124 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include "device.hpp"
+#include "device_pool.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const keyboard_id = uinpp::create_device_id(0, uinpp::DEVICEID_KEYBOARD);
+
+/** Create a finished LOOPBACK keyboard with \a code using \a pool,
+    returns the Device that ended up in \a uinput */
+uinpp::Device* create_keyboard(uinpp::MultiDevice& uinput, uinpp::DevicePool& pool, int code)
+{
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinput.set_device_pool(&pool);
+  uinput.add_key(keyboard_id, code);
+  uinput.finish();
+  return uinput.get_devices().front();
+}
+
+} // namespace
+
+TEST(DevicePoolTest, signature)
+{
+  uinpp::Device lhs(uinpp::DeviceType::KEYBOARD, "Keyboard", input_id{ BUS_VIRTUAL, 1, 2, 3 });
+  uinpp::Device rhs(uinpp::DeviceType::KEYBOARD, "Keyboard", input_id{ BUS_VIRTUAL, 1, 2, 3 });
+  lhs.add_key(KEY_A);
+  rhs.add_key(KEY_A);
+
+  EXPECT_EQ(uinpp::make_device_signature(lhs), uinpp::make_device_signature(rhs));
+  EXPECT_EQ(uinpp::make_device_signature(lhs).hash(), uinpp::make_device_signature(rhs).hash());
+
+  uinpp::Device other_name(uinpp::DeviceType::KEYBOARD, "Other", input_id{ BUS_VIRTUAL, 1, 2, 3 });
+  other_name.add_key(KEY_A);
+  EXPECT_NE(uinpp::make_device_signature(lhs), uinpp::make_device_signature(other_name));
+
+  uinpp::Device other_id(uinpp::DeviceType::KEYBOARD, "Keyboard", input_id{ BUS_VIRTUAL, 1, 2, 4 });
+  other_id.add_key(KEY_A);
+  EXPECT_NE(uinpp::make_device_signature(lhs), uinpp::make_device_signature(other_id));
+
+  rhs.add_key(KEY_B);
+  EXPECT_NE(uinpp::make_device_signature(lhs), uinpp::make_device_signature(rhs));
+}
+
+TEST(DevicePoolTest, adopt_and_release)
+{
+  uinpp::DevicePool pool;
+
+  uinpp::Device* device = nullptr;
+  {
+    uinpp::MultiDevice uinput;
+    device = create_keyboard(uinput, pool, KEY_A);
+  }
+  ASSERT_EQ(pool.size(), 1u);
+
+  {
+    // different layout, a new device is created
+    uinpp::MultiDevice uinput;
+    EXPECT_NE(create_keyboard(uinput, pool, KEY_B), device);
+    EXPECT_EQ(pool.size(), 1u);
+  }
+  ASSERT_EQ(pool.size(), 2u);
+
+  {
+    uinpp::MultiDevice uinput;
+    EXPECT_EQ(create_keyboard(uinput, pool, KEY_A), device);
+    EXPECT_EQ(pool.size(), 1u);
+  }
+  EXPECT_EQ(pool.size(), 2u);
+
+  pool.clear();
+  EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST(DevicePoolTest, held_keys_are_released)
+{
+  uinpp::DevicePool pool;
+
+  int loopback_fd = -1;
+  {
+    uinpp::MultiDevice uinput;
+    uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    uinput.set_device_pool(&pool);
+    uinpp::EventEmitter* key = uinput.add_key(keyboard_id, KEY_A);
+    uinput.finish();
+
+    key->send(1);
+    uinput.sync();
+
+    loopback_fd = uinput.get_devices().front()->get_loopback_fd();
+    uinpp_test::read_loopback(loopback_fd);
+  }
+  ASSERT_EQ(pool.size(), 1u);
+
+  // the pooled device is still alive, so is its loopback fd
+  std::vector<input_event> const events = uinpp_test::read_loopback(loopback_fd);
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].code, KEY_A);
+  EXPECT_EQ(events[0].value, 0);
+  EXPECT_EQ(events[1].type, EV_SYN);
+}
+
+/* EOF */
@@ -0,0 +1,99 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include "device_profile.hpp"
+
+namespace {
+
+constexpr auto test_profile = uinpp::make_device_profile(
+  uinpp::DeviceType::JOYSTICK, "Test Pad",
+  input_id{ BUS_USB, 0x1234, 0x5678, 0x0001 }, (1u << INPUT_PROP_BUTTONPAD),
+  uinpp::profile_key(BTN_A),
+  uinpp::profile_rel(REL_X),
+  uinpp::profile_abs(ABS_X, -100, 100, 1, 2, 3),
+  uinpp::profile_ff(FF_RUMBLE));
+
+static_assert(test_profile.is_valid());
+static_assert(test_profile.entries.size() == 4);
+
+// entries that don't come from the profile_*() helpers are checked by
+// is_valid()
+static_assert(!uinpp::DeviceProfile<1>{
+    uinpp::DeviceType::GENERIC, "", {}, 0, {{ uinpp::ProfileEntry{ EV_KEY, KEY_CNT, 0, 0, 0, 0, 0 } }}
+  }.is_valid());
+static_assert(!uinpp::DeviceProfile<1>{
+    uinpp::DeviceType::GENERIC, "", {}, 0, {{ uinpp::ProfileEntry{ EV_ABS, ABS_X, 1, 0, 0, 0, 0 } }}
+  }.is_valid());
+static_assert(!uinpp::DeviceProfile<1>{
+    uinpp::DeviceType::GENERIC, "", {}, 0, {{ uinpp::ProfileEntry{ EV_SW, 0, 0, 0, 0, 0, 0 } }}
+  }.is_valid());
+
+} // namespace
+
+TEST(DeviceProfileTest, get_capabilities)
+{
+  uinpp::CapabilitySet const caps = test_profile.get_capabilities();
+  EXPECT_TRUE(caps.has_prop(INPUT_PROP_BUTTONPAD));
+  EXPECT_TRUE(caps.has_key(BTN_A));
+  EXPECT_TRUE(caps.has_rel(REL_X));
+  EXPECT_TRUE(caps.has_ff(FF_RUMBLE));
+
+  input_absinfo const* absinfo = caps.get_absinfo(ABS_X);
+  ASSERT_NE(absinfo, nullptr);
+  EXPECT_EQ(absinfo->minimum, -100);
+  EXPECT_EQ(absinfo->maximum, 100);
+  EXPECT_EQ(absinfo->fuzz, 1);
+  EXPECT_EQ(absinfo->flat, 2);
+  EXPECT_EQ(absinfo->resolution, 3);
+}
+
+TEST(DeviceProfileTest, create_device)
+{
+  std::unique_ptr<uinpp::Device> device = uinpp::create_device(uinpp::xbox360_gamepad_profile);
+  device->set_backend(uinpp::DeviceBackend::NONE);
+  device->finish();
+
+  EXPECT_EQ(device->get_type(), uinpp::DeviceType::JOYSTICK);
+  EXPECT_EQ(device->get_name(), "Microsoft X-Box 360 pad");
+  EXPECT_EQ(device->get_id().vendor, 0x045e);
+  EXPECT_EQ(device->get_id().product, 0x028e);
+  EXPECT_EQ(device->get_capabilities(), uinpp::xbox360_gamepad_profile.get_capabilities());
+}
+
+TEST(DeviceProfileTest, create_device_with_name)
+{
+  std::unique_ptr<uinpp::Device> device =
+    uinpp::create_device(uinpp::hires_mouse_profile, "Other Mouse", input_id{ BUS_USB, 1, 2, 3 });
+
+  EXPECT_EQ(device->get_type(), uinpp::DeviceType::MOUSE);
+  EXPECT_EQ(device->get_name(), "Other Mouse");
+  EXPECT_EQ(device->get_id().product, 2);
+  EXPECT_TRUE(device->get_capabilities().has_rel(REL_WHEEL_HI_RES));
+  EXPECT_TRUE(device->get_capabilities().has_prop(INPUT_PROP_POINTER));
+}
+
+TEST(DeviceProfileTest, keyboard)
+{
+  uinpp::CapabilitySet const caps = uinpp::keyboard_profile.get_capabilities();
+  EXPECT_TRUE(caps.has_key(KEY_ESC));
+  EXPECT_TRUE(caps.has_key(KEY_MICMUTE));
+  EXPECT_FALSE(caps.has_key(BTN_A));
+}
+
+/* EOF */
@@ -0,0 +1,91 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+#include <vector>
+
+#include "device.hpp"
+#include "device_reaper.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const keyboard_id = uinpp::create_device_id(0, uinpp::DEVICEID_KEYBOARD);
+
+} // namespace
+
+TEST(DeviceReaperTest, dispose)
+{
+  auto device = std::make_unique<uinpp::Device>(uinpp::DeviceType::KEYBOARD, "Keyboard",
+                                                input_id{ BUS_VIRTUAL, 0, 0, 0 });
+  device->set_backend(uinpp::DeviceBackend::LOOPBACK);
+  device->add_key(KEY_A);
+  device->finish();
+
+  // keep the other end open to see the device going away
+  int const fd = dup(device->get_loopback_fd());
+  ASSERT_GE(fd, 0);
+
+  uinpp::DeviceReaper reaper;
+  reaper.dispose(std::move(device));
+  reaper.wait_idle();
+
+  // end of file, the device closed its end
+  char buf[64];
+  EXPECT_EQ(::read(fd, buf, sizeof(buf)), 0);
+  close(fd);
+}
+
+TEST(DeviceReaperTest, held_keys_are_released_before_handoff)
+{
+  uinpp::DeviceReaper reaper;
+
+  int fd = -1;
+  {
+    uinpp::MultiDevice uinput;
+    uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    uinput.set_device_reaper(&reaper);
+    uinpp::EventEmitter* key = uinput.add_key(keyboard_id, KEY_A);
+    uinput.finish();
+
+    key->send(1);
+    uinput.sync();
+
+    fd = dup(uinput.get_devices().front()->get_loopback_fd());
+    ASSERT_GE(fd, 0);
+
+    uinpp_test::read_loopback(fd);
+  }
+  reaper.wait_idle();
+
+  // the release was written before the device was destroyed
+  std::vector<input_event> const events = uinpp_test::read_loopback(fd);
+  close(fd);
+
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].type, EV_KEY);
+  EXPECT_EQ(events[0].code, KEY_A);
+  EXPECT_EQ(events[0].value, 0);
+  EXPECT_EQ(events[1].type, EV_SYN);
+}
+
+/* EOF */
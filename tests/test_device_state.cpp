@@ -0,0 +1,171 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "device.hpp"
+#include "device_pool.hpp"
+#include "device_state.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const keyboard_id = uinpp::create_device_id(0, uinpp::DEVICEID_KEYBOARD);
+
+class DeviceStateTest : public ::testing::Test
+{
+protected:
+  DeviceStateTest() :
+    m_uinput(),
+    m_states()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_uinput.add_key(keyboard_id, KEY_A);
+    m_uinput.add_led(keyboard_id, LED_NUML);
+    m_uinput.add_led(keyboard_id, LED_CAPSL);
+    m_uinput.add_ff(keyboard_id, FF_RUMBLE);
+    m_uinput.finish();
+
+    m_uinput.set_state_callback(keyboard_id, [this](uinpp::DeviceStateSnapshot const& state) {
+      m_states.push_back(state);
+    });
+  }
+
+  uinpp::Device* get_device()
+  {
+    return m_uinput.get_devices().front();
+  }
+
+  /** hand \a events to the device as if the host had written them */
+  void host_write(std::vector<input_event> const& events)
+  {
+    uinpp_test::write_loopback(get_device()->get_loopback_fd(), events);
+    get_device()->read();
+  }
+
+  uinpp::MultiDevice m_uinput;
+  std::vector<uinpp::DeviceStateSnapshot> m_states;
+};
+
+} // namespace
+
+TEST_F(DeviceStateTest, capabilities)
+{
+  uinpp::CapabilitySet const& caps = get_device()->get_capabilities();
+  EXPECT_TRUE(caps.has_led(LED_NUML));
+  EXPECT_TRUE(caps.has_led(LED_CAPSL));
+  EXPECT_FALSE(caps.has_led(LED_SCROLLL));
+}
+
+TEST_F(DeviceStateTest, leds)
+{
+  uinpp::DeviceState const& state = get_device()->get_state();
+  EXPECT_EQ(state.load(), uinpp::DeviceStateSnapshot{});
+
+  host_write({ input_event{ {}, EV_LED, LED_CAPSL, 1 },
+               input_event{ {}, EV_LED, LED_NUML, 1 } });
+  EXPECT_TRUE(state.load().has_led(LED_CAPSL));
+  EXPECT_TRUE(state.load().has_led(LED_NUML));
+
+  // one notification for all events of a read()
+  ASSERT_EQ(m_states.size(), 1u);
+  EXPECT_EQ(m_states.back(), state.load());
+
+  host_write({ input_event{ {}, EV_LED, LED_NUML, 0 } });
+  EXPECT_TRUE(state.load().has_led(LED_CAPSL));
+  EXPECT_FALSE(state.load().has_led(LED_NUML));
+  EXPECT_EQ(m_states.size(), 2u);
+
+  // no change, no notification
+  host_write({ input_event{ {}, EV_LED, LED_NUML, 0 } });
+  EXPECT_EQ(m_states.size(), 2u);
+}
+
+TEST_F(DeviceStateTest, ff_gain)
+{
+  host_write({ input_event{ {}, EV_FF, FF_GAIN, 0x8000 } });
+  EXPECT_EQ(get_device()->get_state().load().ff_gain, 0x8000);
+  EXPECT_EQ(m_states.size(), 1u);
+
+  // nothing is playing, the magnitudes stay at 0
+  m_uinput.update(10);
+  EXPECT_EQ(get_device()->get_state().load().strong_magnitude, 0);
+  EXPECT_EQ(m_states.size(), 1u);
+}
+
+TEST_F(DeviceStateTest, concurrent_reader)
+{
+  uinpp::DeviceState const& state = get_device()->get_state();
+
+  // the reader must only ever see both LEDs set or both cleared
+  std::atomic<bool> quit = false;
+  std::atomic<int> torn = 0;
+  std::thread reader([&]{
+    while (!quit) {
+      uinpp::DeviceStateSnapshot const snapshot = state.load();
+      if (snapshot.has_led(LED_NUML) != snapshot.has_led(LED_CAPSL)) {
+        torn += 1;
+      }
+    }
+  });
+
+  for (int i = 0; i < 1000; ++i) {
+    host_write({ input_event{ {}, EV_LED, LED_NUML, i % 2 },
+                 input_event{ {}, EV_LED, LED_CAPSL, i % 2 } });
+  }
+
+  quit = true;
+  reader.join();
+  EXPECT_EQ(torn, 0);
+}
+
+TEST(DeviceStatePoolTest, reset_on_release)
+{
+  uinpp::DevicePool pool;
+  auto create_keyboard = [&pool](uinpp::MultiDevice& uinput) {
+    uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    uinput.set_device_pool(&pool);
+    uinput.add_key(keyboard_id, KEY_A);
+    uinput.add_led(keyboard_id, LED_CAPSL);
+    uinput.finish();
+    return uinput.get_devices().front();
+  };
+
+  uinpp::Device* device = nullptr;
+  {
+    uinpp::MultiDevice uinput;
+    device = create_keyboard(uinput);
+
+    input_event const capslock[] = { input_event{ {}, EV_LED, LED_CAPSL, 1 } };
+    uinpp_test::write_loopback(device->get_loopback_fd(), capslock);
+    device->read();
+    ASSERT_TRUE(device->get_state().load().has_led(LED_CAPSL));
+  }
+  ASSERT_EQ(pool.size(), 1u);
+
+  // the next owner doesn't inherit the LEDs of the previous one
+  uinpp::MultiDevice uinput;
+  ASSERT_EQ(create_keyboard(uinput), device);
+  EXPECT_EQ(device->get_state().load(), uinpp::DeviceStateSnapshot{});
+}
+
+/* EOF */
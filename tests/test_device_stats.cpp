@@ -0,0 +1,97 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include "device.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+#include "stats_region.hpp"
+
+TEST(LatencyHistogramTest, percentile)
+{
+  uinpp::LatencyHistogram histogram;
+  EXPECT_EQ(histogram.get_percentile(0.5), 0u);
+
+  for (int i = 0; i < 99; ++i) {
+    histogram.record(1000);
+  }
+  histogram.record(1000000);
+
+  EXPECT_EQ(histogram.get_count(), 100u);
+  EXPECT_EQ(histogram.get_sum(), 99u * 1000u + 1000000u);
+  EXPECT_EQ(histogram.get_percentile(0.5), 1023u);
+  EXPECT_EQ(histogram.get_percentile(1.0), 1048575u);
+}
+
+TEST(StatsRegionTest, shared_with_reader)
+{
+  std::string const name = uinpp::StatsRegion::get_default_name(getpid()) + "-test";
+  auto region = uinpp::StatsRegion::create(name);
+
+  uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+  {
+    uinpp::MultiDevice uinput;
+    uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    uinput.set_stats_region(region.get());
+    uinput.add_rel(mouse_id, REL_X);
+    uinput.finish();
+
+    uinput.send(mouse_id, EV_REL, REL_X, 5);
+    uinput.sync();
+
+    auto reader = uinpp::StatsRegion::open(name);
+    uinpp::StatsRegion::Slot const& slot = reader->get_layout().slots[0];
+    ASSERT_EQ(slot.in_use, 1u);
+    EXPECT_EQ(slot.device_id, mouse_id);
+    EXPECT_EQ(slot.stats.events_written, 2u);
+    EXPECT_EQ(slot.stats.bytes_written, 2 * sizeof(input_event));
+    EXPECT_EQ(slot.stats.write_calls, 1u);
+    EXPECT_EQ(slot.stats.syncs, 1u);
+    EXPECT_EQ(slot.stats.send_latency.get_count(), 1u);
+  }
+
+  EXPECT_EQ(region->get_layout().slots[0].in_use, 0u);
+}
+
+TEST(DeviceStatsTest, external_storage_replaces_internal)
+{
+  uinpp::Device device(uinpp::DeviceType::GENERIC, "test", input_id{ BUS_VIRTUAL, 0, 0, 0 });
+  device.set_backend(uinpp::DeviceBackend::NONE);
+  device.add_rel(REL_X);
+  device.finish();
+
+  std::size_t const internal_usage = device.get_memory_usage();
+  EXPECT_EQ(device.get_stats_storage(), nullptr);
+
+  uinpp::DeviceStats external;
+  device.set_stats_storage(&external);
+  EXPECT_EQ(device.get_stats_storage(), &external);
+  EXPECT_EQ(device.get_memory_usage(), internal_usage - sizeof(uinpp::DeviceStats));
+
+  device.send(EV_REL, REL_X, 1);
+  device.sync();
+  EXPECT_EQ(external.syncs, 1u);
+
+  device.set_stats_storage(nullptr);
+  EXPECT_EQ(device.get_stats_storage(), nullptr);
+  EXPECT_EQ(device.get_memory_usage(), internal_usage);
+  EXPECT_EQ(device.get_stats().syncs, 0u);
+}
+
+/* EOF */
@@ -0,0 +1,153 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <random>
+
+#include "event_emitter.hpp"
+#include "filter_bank.hpp"
+
+namespace {
+
+/** counts the values it was send */
+class CountingEmitter : public uinpp::EventEmitter
+{
+public:
+  void send(int value) override { m_value = value; m_count += 1; }
+  int m_value = 0;
+  int m_count = 0;
+};
+
+} // namespace
+
+TEST(FilterBankTest, none_passes_through)
+{
+  uinpp::FilterBank bank;
+  bank.add_axis(nullptr, uinpp::FilterConfig{});
+
+  std::array<int, 1> out = {};
+  for (int v : { 5, -100, 32767, 0 }) {
+    bank.process(std::array<int, 1>{ v }, 0.001f, out);
+    EXPECT_EQ(out[0], v);
+  }
+}
+
+TEST(FilterBankTest, ema_converges)
+{
+  uinpp::FilterBank bank;
+  bank.add_axis(nullptr, uinpp::FilterConfig{.type = uinpp::FilterType::EMA, .alpha = 0.5f});
+
+  std::array<int, 1> out = {};
+  bank.process(std::array<int, 1>{ 0 }, 0.001f, out);
+  bank.process(std::array<int, 1>{ 1000 }, 0.001f, out);
+  EXPECT_EQ(out[0], 500);
+  bank.process(std::array<int, 1>{ 1000 }, 0.001f, out);
+  EXPECT_EQ(out[0], 750);
+
+  for (int i = 0; i < 32; ++i) {
+    bank.process(std::array<int, 1>{ 1000 }, 0.001f, out);
+  }
+  EXPECT_EQ(out[0], 1000);
+}
+
+TEST(FilterBankTest, noisy_axis_at_rest_is_quiet)
+{
+  CountingEmitter raw_emitter;
+  CountingEmitter filtered_emitter;
+
+  uinpp::FilterBank bank;
+  bank.add_axis(&raw_emitter, uinpp::FilterConfig{});
+  bank.add_axis(&filtered_emitter, uinpp::FilterConfig{
+      .type = uinpp::FilterType::ONE_EURO,
+      .min_cutoff = 1.0f,
+      .beta = 0.01f,
+      .hysteresis = 8.0f });
+
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> noise(-30, 30);
+  for (int i = 0; i < 1000; ++i)
+  {
+    int const v = 1000 + noise(rng);
+    bank.send(std::array<int, 2>{ v, v }, 0.004f);
+  }
+
+  EXPECT_GT(raw_emitter.m_count, 900);
+  EXPECT_LT(filtered_emitter.m_count, 50);
+  EXPECT_NEAR(filtered_emitter.m_value, 1000, 16);
+}
+
+TEST(FilterBankTest, one_euro_follows_fast_movement)
+{
+  uinpp::FilterBank bank;
+  bank.add_axis(nullptr, uinpp::FilterConfig{.type = uinpp::FilterType::ONE_EURO, .min_cutoff = 1.0f, .beta = 0.0f});
+  bank.add_axis(nullptr, uinpp::FilterConfig{.type = uinpp::FilterType::ONE_EURO, .min_cutoff = 1.0f, .beta = 0.1f});
+
+  std::array<int, 2> out = {};
+  bank.process(std::array<int, 2>{ 0, 0 }, 0.004f, out);
+  for (int i = 1; i <= 25; ++i) {
+    bank.process(std::array<int, 2>{ i * 1000, i * 1000 }, 0.004f, out);
+  }
+
+  // the speed term lets the second axis catch up with the ramp
+  EXPECT_LT(out[0], 10000);
+  EXPECT_GT(out[1], 23000);
+}
+
+TEST(FilterBankTest, reset_passes_next_report)
+{
+  uinpp::FilterBank bank;
+  bank.add_axis(nullptr, uinpp::FilterConfig{.type = uinpp::FilterType::EMA, .alpha = 0.1f});
+
+  std::array<int, 1> out = {};
+  bank.process(std::array<int, 1>{ 0 }, 0.001f, out);
+  bank.process(std::array<int, 1>{ 1000 }, 0.001f, out);
+  EXPECT_EQ(out[0], 100);
+
+  bank.reset();
+  bank.process(std::array<int, 1>{ 1000 }, 0.001f, out);
+  EXPECT_EQ(out[0], 1000);
+}
+
+TEST(FilterBankTest, zero_dt_keeps_filter_state)
+{
+  uinpp::FilterBank bank;
+  bank.add_axis(nullptr, uinpp::FilterConfig{.type = uinpp::FilterType::EMA, .alpha = 0.1f});
+
+  std::array<int, 1> out = {};
+  bank.process(std::array<int, 1>{ 0 }, 0.001f, out);
+  bank.process(std::array<int, 1>{ 1000 }, 0.0f, out);
+  EXPECT_EQ(out[0], 100);
+  bank.process(std::array<int, 1>{ 1000 }, -0.001f, out);
+  EXPECT_EQ(out[0], 190);
+}
+
+TEST(FilterBankTest, zero_dt_keeps_hysteresis)
+{
+  uinpp::FilterBank bank;
+  bank.add_axis(nullptr, uinpp::FilterConfig{.type = uinpp::FilterType::NONE, .hysteresis = 10.0f});
+
+  std::array<int, 1> out = {};
+  bank.process(std::array<int, 1>{ 100 }, 0.001f, out);
+  bank.process(std::array<int, 1>{ 105 }, 0.0f, out);
+  EXPECT_EQ(out[0], 100);
+  bank.process(std::array<int, 1>{ 120 }, 0.0f, out);
+  EXPECT_EQ(out[0], 120);
+}
+
+/* EOF */
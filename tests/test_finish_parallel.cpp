@@ -0,0 +1,112 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <set>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "device.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+/** Limits the process to \a free_fds more file descriptors for its
+    lifetime, so that creating a LOOPBACK device can fail */
+class FdLimit
+{
+public:
+  FdLimit(int free_fds) :
+    m_old()
+  {
+    getrlimit(RLIMIT_NOFILE, &m_old);
+
+    int const next_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    close(next_fd);
+
+    rlimit limit = m_old;
+    limit.rlim_cur = static_cast<rlim_t>(next_fd + free_fds);
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  ~FdLimit()
+  {
+    setrlimit(RLIMIT_NOFILE, &m_old);
+  }
+
+private:
+  rlimit m_old;
+};
+
+} // namespace
+
+TEST(FinishParallelTest, finishes_all_devices)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  for (uint16_t slot = 0; slot < 8; ++slot) {
+    uinput.add_key(uinpp::create_device_id(slot, uinpp::DEVICEID_KEYBOARD), KEY_A);
+  }
+
+  std::vector<uinpp::DeviceFinishResult> const results = uinput.finish_parallel(3);
+  ASSERT_EQ(results.size(), 8u);
+
+  std::set<uint32_t> device_ids;
+  for (auto const& result : results) {
+    EXPECT_FALSE(result.error);
+    device_ids.insert(result.device_id);
+  }
+  EXPECT_EQ(device_ids.size(), 8u);
+
+  for (uinpp::Device* device : uinput.get_devices()) {
+    EXPECT_TRUE(device->is_finished());
+  }
+}
+
+TEST(FinishParallelTest, collects_errors_per_device)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  for (uint16_t slot = 0; slot < 3; ++slot) {
+    uinput.add_key(uinpp::create_device_id(slot, uinpp::DEVICEID_KEYBOARD), KEY_A);
+  }
+
+  std::vector<uinpp::DeviceFinishResult> results;
+  {
+    // room for the socket pair of a single device
+    FdLimit limit(2);
+    results = uinput.finish_parallel(1);
+  }
+  ASSERT_EQ(results.size(), 3u);
+
+  int failed = 0;
+  for (auto const& result : results)
+  {
+    if (result.error)
+    {
+      failed += 1;
+      EXPECT_THROW(std::rethrow_exception(result.error), std::runtime_error);
+    }
+  }
+  EXPECT_EQ(failed, 2);
+}
+
+/* EOF */
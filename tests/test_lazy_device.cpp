@@ -0,0 +1,164 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "device.hpp"
+#include "device_pool.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const keyboard_id = uinpp::create_device_id(0, uinpp::DEVICEID_KEYBOARD);
+uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+
+/** sync() until the lazy creation of \a device_id is done */
+void wait_for_device(uinpp::MultiDevice& uinput, uint32_t device_id)
+{
+  for (int i = 0; i < 1000 && uinput.is_device_pending(device_id); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    uinput.sync();
+  }
+  ASSERT_FALSE(uinput.is_device_pending(device_id));
+}
+
+} // namespace
+
+TEST(LazyDeviceTest, created_on_first_event)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinput.set_lazy(true);
+  uinpp::EventEmitter* key = uinput.add_key(keyboard_id, KEY_A);
+  uinput.finish();
+
+  // nothing send, nothing created
+  uinput.sync();
+  uinput.update(10);
+  EXPECT_TRUE(uinput.is_device_pending(keyboard_id));
+  EXPECT_TRUE(uinput.get_devices().empty());
+
+  key->send(1);
+  uinput.sync();
+  key->send(0);
+  uinput.sync();
+  wait_for_device(uinput, keyboard_id);
+
+  // the events queued during creation come out in order, frame by frame
+  uinpp::Device const* device = uinput.get_devices().front();
+  EXPECT_TRUE(device->is_finished());
+
+  std::vector<input_event> const events = uinpp_test::read_loopback(device->get_loopback_fd());
+  ASSERT_EQ(events.size(), 4u);
+  EXPECT_EQ(events[0].code, KEY_A);
+  EXPECT_EQ(events[0].value, 1);
+  EXPECT_EQ(events[1].type, EV_SYN);
+  EXPECT_EQ(events[2].code, KEY_A);
+  EXPECT_EQ(events[2].value, 0);
+  EXPECT_EQ(events[3].type, EV_SYN);
+}
+
+TEST(LazyDeviceTest, mandatory_capabilities_up_front)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinput.set_lazy(true);
+  uinput.add_rel(mouse_id, REL_X);
+  uinput.finish();
+
+  // the hi-res wheel is known before the device exists
+  uinput.send_scroll(mouse_id, REL_WHEEL, 120);
+  uinput.sync();
+  wait_for_device(uinput, mouse_id);
+
+  uinpp::Device const* device = uinput.get_devices().front();
+  EXPECT_TRUE(device->get_capabilities().has_rel(REL_WHEEL_HI_RES));
+
+  std::vector<input_event> const events = uinpp_test::read_loopback(device->get_loopback_fd());
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].code, REL_WHEEL_HI_RES);
+  EXPECT_EQ(events[0].value, 120);
+  EXPECT_EQ(events[1].code, REL_WHEEL);
+  EXPECT_EQ(events[1].value, 1);
+}
+
+TEST(LazyDeviceTest, adopts_pooled_device)
+{
+  uinpp::DevicePool pool;
+
+  uinpp::Device* pooled = nullptr;
+  {
+    uinpp::MultiDevice uinput;
+    uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    uinput.set_device_pool(&pool);
+    uinput.add_key(keyboard_id, KEY_A);
+    uinput.finish();
+    pooled = uinput.get_devices().front();
+  }
+  ASSERT_EQ(pool.size(), 1u);
+
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinput.set_device_pool(&pool);
+  uinput.set_lazy(true);
+  uinpp::EventEmitter* key = uinput.add_key(keyboard_id, KEY_A);
+  uinput.finish();
+  EXPECT_EQ(pool.size(), 1u);
+
+  // adoption doesn't need to wait for the kernel
+  key->send(1);
+  EXPECT_FALSE(uinput.is_device_pending(keyboard_id));
+  EXPECT_EQ(pool.size(), 0u);
+  EXPECT_EQ(uinput.get_devices().front(), pooled);
+
+  uinput.sync();
+  std::vector<input_event> const events = uinpp_test::read_loopback(pooled->get_loopback_fd());
+  ASSERT_FALSE(events.empty());
+  EXPECT_EQ(events.back().type, EV_SYN);
+}
+
+TEST(LazyDeviceTest, pending_queue_is_bounded)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinput.set_lazy(true);
+  uinput.add_key(keyboard_id, KEY_A);
+  uinput.finish();
+
+  // without a sync() nothing gets flushed, the queue has to take all
+  int const count = 1000;
+  for (int i = 0; i < count; ++i) {
+    uinput.send(keyboard_id, EV_KEY, KEY_A, (i + 1) % 2);
+  }
+  EXPECT_TRUE(uinput.get_devices().empty());
+  wait_for_device(uinput, keyboard_id);
+
+  uinpp::Device const* device = uinput.get_devices().front();
+  std::vector<input_event> const events = uinpp_test::read_loopback(device->get_loopback_fd());
+  ASSERT_EQ(events.size(), uinpp::MultiDevice::MAX_LAZY_PENDING + 1);
+  EXPECT_EQ(events.back().type, EV_SYN);
+  EXPECT_EQ(device->get_stats().dropped_events, count - uinpp::MultiDevice::MAX_LAZY_PENDING);
+}
+
+/* EOF */
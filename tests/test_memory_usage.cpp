@@ -0,0 +1,61 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include "device.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+TEST(MemoryUsageTest, counts)
+{
+  uint32_t const keyboard_id = uinpp::create_device_id(0, uinpp::DEVICEID_KEYBOARD);
+  uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::NONE);
+
+  uinpp::MemoryUsage const empty = uinput.get_memory_usage();
+  EXPECT_EQ(empty.collector_count, 0u);
+  EXPECT_EQ(empty.emitter_count, 0u);
+  EXPECT_EQ(empty.device_count, 0u);
+  EXPECT_EQ(empty.device_bytes, 0u);
+
+  // two emitters share the collector of KEY_A
+  uinput.add_key(keyboard_id, KEY_A);
+  uinput.add_key(keyboard_id, KEY_A);
+  uinput.add_key(keyboard_id, KEY_B);
+  uinput.add_rel(mouse_id, REL_X);
+  uinput.finish();
+
+  uinpp::MemoryUsage const usage = uinput.get_memory_usage();
+  EXPECT_EQ(usage.collector_count, 3u);
+  EXPECT_EQ(usage.emitter_count, 4u);
+  EXPECT_EQ(usage.device_count, 2u);
+  EXPECT_GE(usage.device_bytes, 2 * sizeof(uinpp::Device));
+
+  EXPECT_GT(usage.arena_bytes_used, empty.arena_bytes_used);
+  EXPECT_GE(usage.arena_bytes_reserved, usage.arena_bytes_used);
+
+  std::size_t device_bytes = 0;
+  for (uinpp::Device const* device : uinput.get_devices()) {
+    device_bytes += device->get_memory_usage();
+  }
+  EXPECT_EQ(usage.device_bytes, device_bytes);
+}
+
+/* EOF */
@@ -0,0 +1,193 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const joystick_id = uinpp::create_device_id(0, uinpp::DEVICEID_JOYSTICK);
+
+class MergePolicyTest : public ::testing::Test
+{
+protected:
+  MergePolicyTest() :
+    m_uinput()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_abs_a = m_uinput.add_abs(joystick_id, ABS_X, -100, 100, 0, 0, 0);
+    m_abs_b = m_uinput.add_abs(joystick_id, ABS_X, -100, 100, 0, 0, 0);
+    m_rel_a = m_uinput.add_rel(joystick_id, REL_X);
+    m_rel_b = m_uinput.add_rel(joystick_id, REL_X);
+    m_key_a = m_uinput.add_key(joystick_id, BTN_A);
+    m_key_b = m_uinput.add_key(joystick_id, BTN_A);
+  }
+
+  /** the non-SYN events written since the last call */
+  std::vector<input_event> read_events()
+  {
+    std::vector<input_event> events = uinpp_test::read_loopback(m_uinput.get_devices().front()->get_loopback_fd());
+    std::erase_if(events, [](input_event const& ev) { return ev.type == EV_SYN; });
+    return events;
+  }
+
+  uinpp::MultiDevice m_uinput;
+  uinpp::EventEmitter* m_abs_a = nullptr;
+  uinpp::EventEmitter* m_abs_b = nullptr;
+  uinpp::EventEmitter* m_rel_a = nullptr;
+  uinpp::EventEmitter* m_rel_b = nullptr;
+  uinpp::EventEmitter* m_key_a = nullptr;
+  uinpp::EventEmitter* m_key_b = nullptr;
+};
+
+} // namespace
+
+TEST_F(MergePolicyTest, one_event_per_frame)
+{
+  m_uinput.finish();
+
+  m_abs_a->send(10);
+  m_abs_b->send(20);
+  m_abs_a->send(30);
+  m_rel_a->send(1);
+  m_rel_b->send(2);
+  m_rel_a->send(3);
+  m_uinput.sync();
+
+  auto events = read_events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].type, EV_ABS);
+  EXPECT_EQ(events[0].value, 30);
+  EXPECT_EQ(events[1].type, EV_REL);
+  EXPECT_EQ(events[1].value, 6);
+
+  // the merged value didn't change, nothing is send
+  m_abs_b->send(30);
+  m_uinput.sync();
+  EXPECT_TRUE(read_events().empty());
+}
+
+TEST_F(MergePolicyTest, abs_max_magnitude)
+{
+  m_uinput.set_merge_policy(joystick_id, EV_ABS, ABS_X, uinpp::MergePolicy::MAX_MAGNITUDE);
+  m_uinput.finish();
+
+  m_abs_a->send(-50);
+  m_abs_b->send(20);
+  m_uinput.sync();
+  m_abs_b->send(-10);
+  m_uinput.sync();
+  m_abs_a->send(5);
+  m_uinput.sync();
+
+  auto const events = read_events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].value, -50);
+  EXPECT_EQ(events[1].value, -10);
+}
+
+TEST_F(MergePolicyTest, abs_sum_is_clamped)
+{
+  m_uinput.set_merge_policy(joystick_id, EV_ABS, ABS_X, uinpp::MergePolicy::SUM);
+  m_uinput.finish();
+
+  m_abs_a->send(30);
+  m_abs_b->send(40);
+  m_uinput.sync();
+  m_abs_b->send(90);
+  m_uinput.sync();
+
+  auto const events = read_events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].value, 70);
+  EXPECT_EQ(events[1].value, 100);
+}
+
+TEST_F(MergePolicyTest, abs_priority)
+{
+  m_uinput.set_merge_policy(joystick_id, EV_ABS, ABS_X, uinpp::MergePolicy::PRIORITY);
+  m_uinput.finish();
+
+  m_abs_b->send(40);
+  m_uinput.sync();
+  m_abs_a->send(-20);
+  m_uinput.sync();
+  m_abs_b->send(60);
+  m_uinput.sync();
+  m_abs_a->send(0);
+  m_uinput.sync();
+
+  auto const events = read_events();
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].value, 40);
+  EXPECT_EQ(events[1].value, -20);
+  EXPECT_EQ(events[2].value, 60);
+}
+
+TEST_F(MergePolicyTest, rel_max_magnitude)
+{
+  m_uinput.set_merge_policy(joystick_id, EV_REL, REL_X, uinpp::MergePolicy::MAX_MAGNITUDE);
+  m_uinput.finish();
+
+  m_rel_a->send(3);
+  m_rel_b->send(-5);
+  m_rel_a->send(1);
+  m_uinput.sync();
+
+  auto const events = read_events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].value, -5);
+}
+
+TEST_F(MergePolicyTest, keys)
+{
+  EXPECT_THROW(m_uinput.set_merge_policy(joystick_id, EV_KEY, BTN_A, uinpp::MergePolicy::SUM), std::runtime_error);
+  EXPECT_THROW(m_uinput.set_merge_policy(joystick_id, EV_ABS, ABS_X, uinpp::MergePolicy::OR), std::runtime_error);
+  EXPECT_THROW(m_uinput.set_merge_policy(joystick_id, EV_KEY, BTN_B, uinpp::MergePolicy::OR), std::runtime_error);
+  m_uinput.finish();
+
+  // OR, a press and release within a frame keeps both edges
+  m_key_a->send(1);
+  m_key_b->send(1);
+  m_key_a->send(0);
+  m_key_b->send(0);
+  m_uinput.sync();
+
+  auto events = read_events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].value, 1);
+  EXPECT_EQ(events[1].value, 0);
+
+  m_uinput.set_merge_policy(joystick_id, EV_KEY, BTN_A, uinpp::MergePolicy::LAST_WRITER);
+  m_key_a->send(1);
+  m_key_b->send(1);
+  m_key_b->send(0);
+  m_uinput.sync();
+
+  events = read_events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].value, 1);
+  EXPECT_EQ(events[1].value, 0);
+}
+
+/* EOF */
@@ -0,0 +1,145 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device.hpp"
+#include "device_stats.hpp"
+#include "loopback_reader.hpp"
+#include "motion_sensor.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const sensor_id = uinpp::create_device_id(0, 1);
+
+using uinpp_test::Ev;
+
+class MotionSensorTest : public ::testing::Test
+{
+protected:
+  MotionSensorTest() :
+    m_uinput(),
+    m_sensor()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_sensor = std::make_unique<uinpp::MotionSensor>(m_uinput, sensor_id, uinpp::MotionSensorConfig{});
+    m_uinput.finish();
+  }
+
+  uinpp::Device* get_device()
+  {
+    return m_uinput.get_devices().front();
+  }
+
+  /** everything written since the last call, including SYN_REPORT */
+  std::vector<Ev> read()
+  {
+    return uinpp_test::read_loopback_evs(get_device()->get_loopback_fd());
+  }
+
+  uinpp::MultiDevice m_uinput;
+  std::unique_ptr<uinpp::MotionSensor> m_sensor;
+};
+
+} // namespace
+
+TEST_F(MotionSensorTest, capabilities)
+{
+  uinpp::Device const* device = get_device();
+  EXPECT_EQ(device->get_type(), uinpp::DeviceType::SENSOR);
+
+  uinpp::CapabilitySet const& caps = device->get_capabilities();
+  EXPECT_TRUE(caps.has_prop(INPUT_PROP_ACCELEROMETER));
+  EXPECT_TRUE(caps.has_msc(MSC_TIMESTAMP));
+  EXPECT_EQ(caps.get_absinfo(ABS_Z)->maximum, 4 * 8192);
+  EXPECT_EQ(caps.get_absinfo(ABS_Z)->resolution, 8192);
+  EXPECT_EQ(caps.get_absinfo(ABS_RZ)->minimum, -2048 * 1024);
+  EXPECT_EQ(caps.get_absinfo(ABS_RZ)->resolution, 1024);
+}
+
+TEST_F(MotionSensorTest, send)
+{
+  m_sensor->send(uinpp::ImuSample{{0, 8192, 0}, {10, 20, 30}, 1000});
+  EXPECT_EQ(read(), (std::vector<Ev>{
+        {EV_ABS, ABS_X, 0},
+        {EV_ABS, ABS_Y, 8192},
+        {EV_ABS, ABS_Z, 0},
+        {EV_ABS, ABS_RX, 10},
+        {EV_ABS, ABS_RY, 20},
+        {EV_ABS, ABS_RZ, 30},
+        {EV_MSC, MSC_TIMESTAMP, 1000},
+        {EV_SYN, SYN_REPORT, 0}}));
+
+  // only the changed axes, the timestamp always
+  m_sensor->send(uinpp::ImuSample{{0, 8192, 0}, {10, 25, 30}, 2000});
+  EXPECT_EQ(read(), (std::vector<Ev>{
+        {EV_ABS, ABS_RY, 25},
+        {EV_MSC, MSC_TIMESTAMP, 2000},
+        {EV_SYN, SYN_REPORT, 0}}));
+
+  m_sensor->send(uinpp::ImuSample{{0, 8192, 0}, {10, 25, 30}, 3000});
+  EXPECT_EQ(read(), (std::vector<Ev>{
+        {EV_MSC, MSC_TIMESTAMP, 3000},
+        {EV_SYN, SYN_REPORT, 0}}));
+}
+
+TEST_F(MotionSensorTest, send_batch)
+{
+  std::vector<uinpp::ImuSample> const samples = {
+    {{1, 2, 3}, {4, 5, 6}, 1000},
+    {{1, 2, 4}, {4, 5, 6}, 2000},
+    {{1, 2, 4}, {7, 5, 6}, 3000},
+  };
+
+  uint64_t const write_calls = get_device()->get_stats().write_calls;
+  uint64_t const syncs = get_device()->get_stats().syncs;
+  m_sensor->send_batch(samples);
+  EXPECT_EQ(get_device()->get_stats().write_calls, write_calls + 1);
+  EXPECT_EQ(get_device()->get_stats().syncs, syncs + 3);
+
+  EXPECT_EQ(read(), (std::vector<Ev>{
+        {EV_ABS, ABS_X, 1},
+        {EV_ABS, ABS_Y, 2},
+        {EV_ABS, ABS_Z, 3},
+        {EV_ABS, ABS_RX, 4},
+        {EV_ABS, ABS_RY, 5},
+        {EV_ABS, ABS_RZ, 6},
+        {EV_MSC, MSC_TIMESTAMP, 1000},
+        {EV_SYN, SYN_REPORT, 0},
+        {EV_ABS, ABS_Z, 4},
+        {EV_MSC, MSC_TIMESTAMP, 2000},
+        {EV_SYN, SYN_REPORT, 0},
+        {EV_ABS, ABS_RX, 7},
+        {EV_MSC, MSC_TIMESTAMP, 3000},
+        {EV_SYN, SYN_REPORT, 0}}));
+}
+
+TEST_F(MotionSensorTest, pending_frame_goes_first)
+{
+  m_uinput.send(sensor_id, EV_ABS, ABS_X, 100);
+  m_sensor->send(uinpp::ImuSample{{100, 0, 0}, {0, 0, 0}, 1000});
+
+  std::vector<Ev> const events = read();
+  ASSERT_FALSE(events.empty());
+  EXPECT_EQ(events.front(), (Ev{EV_ABS, ABS_X, 100}));
+}
+
+/* EOF */
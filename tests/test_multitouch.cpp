@@ -0,0 +1,145 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "multitouch.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const touchpad_id = uinpp::create_device_id(0, 1);
+
+using uinpp_test::Ev;
+
+class MultitouchTest : public ::testing::Test
+{
+protected:
+  MultitouchTest() :
+    m_uinput(),
+    m_touch()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_touch = std::make_unique<uinpp::Multitouch>(m_uinput, touchpad_id, uinpp::DeviceType::TOUCHPAD,
+                                                  uinpp::MultitouchConfig{.num_slots = 3});
+    m_uinput.finish();
+  }
+
+  /** send() the frame and return what was written, without SYN_REPORT */
+  std::vector<Ev> send()
+  {
+    m_touch->send();
+    m_uinput.sync();
+
+    return uinpp_test::without_syn(
+      uinpp_test::read_loopback_evs(m_uinput.get_devices().front()->get_loopback_fd()));
+  }
+
+  uinpp::MultiDevice m_uinput;
+  std::unique_ptr<uinpp::Multitouch> m_touch;
+};
+
+} // namespace
+
+TEST_F(MultitouchTest, capabilities)
+{
+  uinpp::Device const* device = m_uinput.get_devices().front();
+  EXPECT_EQ(device->get_type(), uinpp::DeviceType::TOUCHPAD);
+
+  uinpp::CapabilitySet const& caps = device->get_capabilities();
+  EXPECT_TRUE(caps.has_prop(INPUT_PROP_POINTER));
+  EXPECT_TRUE(caps.has_key(BTN_TOUCH));
+  EXPECT_TRUE(caps.has_key(BTN_TOOL_FINGER));
+  EXPECT_TRUE(caps.has_key(BTN_TOOL_TRIPLETAP));
+  EXPECT_FALSE(caps.has_key(BTN_TOOL_QUADTAP));
+  EXPECT_EQ(caps.get_absinfo(ABS_MT_SLOT)->maximum, 2);
+  EXPECT_EQ(caps.get_absinfo(ABS_X)->maximum, 1919);
+
+  EXPECT_THROW(m_uinput.set_output_interval(touchpad_id, 8), std::runtime_error);
+}
+
+TEST_F(MultitouchTest, protocol_b)
+{
+  m_touch->set_contact(0, 100, 200);
+  EXPECT_EQ(send(), (std::vector<Ev>{
+        {EV_ABS, ABS_MT_TRACKING_ID, 0},
+        {EV_ABS, ABS_MT_POSITION_X, 100},
+        {EV_ABS, ABS_MT_POSITION_Y, 200},
+        {EV_KEY, BTN_TOUCH, 1},
+        {EV_KEY, BTN_TOOL_FINGER, 1},
+        {EV_ABS, ABS_X, 100},
+        {EV_ABS, ABS_Y, 200}}));
+
+  // nothing changed, nothing send
+  EXPECT_TRUE(send().empty());
+
+  // only the changed axis
+  m_touch->set_contact(0, 100, 210);
+  EXPECT_EQ(send(), (std::vector<Ev>{
+        {EV_ABS, ABS_MT_POSITION_Y, 210},
+        {EV_ABS, ABS_Y, 210}}));
+
+  // second finger, the pointer stays with the first one
+  m_touch->set_contact(2, 500, 600);
+  EXPECT_EQ(send(), (std::vector<Ev>{
+        {EV_ABS, ABS_MT_SLOT, 2},
+        {EV_ABS, ABS_MT_TRACKING_ID, 1},
+        {EV_ABS, ABS_MT_POSITION_X, 500},
+        {EV_ABS, ABS_MT_POSITION_Y, 600},
+        {EV_KEY, BTN_TOOL_FINGER, 0},
+        {EV_KEY, BTN_TOOL_DOUBLETAP, 1}}));
+
+  // first finger lifted, the pointer moves over to the second
+  m_touch->release_contact(0);
+  m_touch->set_contact(2, 510, 600);
+  EXPECT_EQ(send(), (std::vector<Ev>{
+        {EV_ABS, ABS_MT_SLOT, 0},
+        {EV_ABS, ABS_MT_TRACKING_ID, -1},
+        {EV_ABS, ABS_MT_SLOT, 2},
+        {EV_ABS, ABS_MT_POSITION_X, 510},
+        {EV_KEY, BTN_TOOL_DOUBLETAP, 0},
+        {EV_KEY, BTN_TOOL_FINGER, 1},
+        {EV_ABS, ABS_X, 510},
+        {EV_ABS, ABS_Y, 600}}));
+
+  // lift and touch again within a frame is a new contact
+  m_touch->release_contact(2);
+  m_touch->set_contact(2, 510, 600);
+  EXPECT_EQ(send(), (std::vector<Ev>{
+        {EV_ABS, ABS_MT_TRACKING_ID, 2},
+        {EV_ABS, ABS_MT_POSITION_X, 510},
+        {EV_ABS, ABS_MT_POSITION_Y, 600}}));
+
+  m_touch->release_all();
+  EXPECT_EQ(send(), (std::vector<Ev>{
+        {EV_ABS, ABS_MT_TRACKING_ID, -1},
+        {EV_KEY, BTN_TOUCH, 0},
+        {EV_KEY, BTN_TOOL_FINGER, 0}}));
+}
+
+TEST(MultitouchConfigTest, invalid_type)
+{
+  uinpp::MultiDevice uinput;
+  EXPECT_THROW(uinpp::Multitouch(uinput, touchpad_id, uinpp::DeviceType::MOUSE, uinpp::MultitouchConfig{}),
+               std::runtime_error);
+}
+
+/* EOF */
@@ -0,0 +1,148 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+
+class OutputRateTest : public ::testing::Test
+{
+protected:
+  OutputRateTest() :
+    m_uinput()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_uinput.add_rel(mouse_id, REL_X);
+    m_uinput.add_abs(mouse_id, ABS_X, 0, 1000, 0, 0, 0);
+    m_uinput.add_key(mouse_id, BTN_LEFT);
+    m_uinput.set_output_interval(mouse_id, 8);
+    m_uinput.finish();
+  }
+
+  /** the frames written since the last call, without the SYN_REPORT */
+  std::vector<std::vector<input_event>> read_frames()
+  {
+    std::vector<std::vector<input_event>> frames;
+    std::vector<input_event> frame;
+
+    for (input_event const& ev : uinpp_test::read_loopback(m_uinput.get_devices().front()->get_loopback_fd())) {
+      if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+        frames.emplace_back(std::move(frame));
+        frame.clear();
+      } else {
+        frame.emplace_back(ev);
+      }
+    }
+    return frames;
+  }
+
+  uinpp::MultiDevice m_uinput;
+};
+
+} // namespace
+
+TEST_F(OutputRateTest, nothing_written_before_tick)
+{
+  m_uinput.send(mouse_id, EV_REL, REL_X, 1);
+  m_uinput.sync();
+  m_uinput.update(4);
+
+  EXPECT_TRUE(read_frames().empty());
+
+  m_uinput.update(4);
+  EXPECT_EQ(read_frames().size(), 1u);
+}
+
+TEST_F(OutputRateTest, abs_latest_wins_and_rel_summed)
+{
+  for (int i = 0; i < 8; ++i)
+  {
+    m_uinput.send(mouse_id, EV_REL, REL_X, 3);
+    m_uinput.send(mouse_id, EV_ABS, ABS_X, 100 + i);
+    m_uinput.sync();
+  }
+  m_uinput.update(8);
+
+  auto const frames = read_frames();
+  ASSERT_EQ(frames.size(), 1u);
+  ASSERT_EQ(frames[0].size(), 2u);
+  EXPECT_EQ(frames[0][0].type, EV_ABS);
+  EXPECT_EQ(frames[0][0].value, 107);
+  EXPECT_EQ(frames[0][1].type, EV_REL);
+  EXPECT_EQ(frames[0][1].value, 24);
+
+  EXPECT_EQ(m_uinput.get_devices().front()->get_stats().coalesced_events.load(), 14u);
+}
+
+TEST_F(OutputRateTest, key_edges_are_kept)
+{
+  // a click within a single tick
+  m_uinput.send(mouse_id, EV_KEY, BTN_LEFT, 1);
+  m_uinput.sync();
+  m_uinput.send(mouse_id, EV_KEY, BTN_LEFT, 0);
+  m_uinput.sync();
+  m_uinput.send(mouse_id, EV_KEY, BTN_LEFT, 1);
+  m_uinput.sync();
+  m_uinput.update(8);
+
+  auto const frames = read_frames();
+  ASSERT_EQ(frames.size(), 3u);
+  EXPECT_EQ(frames[0].at(0).value, 1);
+  EXPECT_EQ(frames[1].at(0).value, 0);
+  EXPECT_EQ(frames[2].at(0).value, 1);
+}
+
+TEST_F(OutputRateTest, disabling_writes_pending)
+{
+  m_uinput.send(mouse_id, EV_REL, REL_X, 5);
+  m_uinput.sync();
+  m_uinput.set_output_interval(mouse_id, 0);
+
+  auto frames = read_frames();
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].at(0).value, 5);
+
+  // back to a frame per sync()
+  m_uinput.send(mouse_id, EV_REL, REL_X, 1);
+  m_uinput.sync();
+  m_uinput.send(mouse_id, EV_REL, REL_X, 1);
+  m_uinput.sync();
+  EXPECT_EQ(read_frames().size(), 2u);
+}
+
+TEST_F(OutputRateTest, disabling_frees_pending)
+{
+  uinpp::Device const* device = m_uinput.get_devices().front();
+  size_t const limited = device->get_memory_usage();
+
+  m_uinput.set_output_interval(mouse_id, 0);
+  EXPECT_LT(device->get_memory_usage(), limited);
+
+  m_uinput.set_output_interval(mouse_id, 8);
+  EXPECT_EQ(device->get_memory_usage(), limited);
+}
+
+/* EOF */
@@ -0,0 +1,43 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "parse.hpp"
+
+TEST(ParseTest, int_list)
+{
+  EXPECT_EQ(uinpp::parse_int_list("4"), std::vector<int>({ 4 }));
+  EXPECT_EQ(uinpp::parse_int_list("1,4"), std::vector<int>({ 1, 4 }));
+  EXPECT_EQ(uinpp::parse_int_list("1,4,16"), std::vector<int>({ 1, 4, 16 }));
+  EXPECT_EQ(uinpp::parse_int_list("-2,0"), std::vector<int>({ -2, 0 }));
+}
+
+TEST(ParseTest, int_list_invalid)
+{
+  EXPECT_THROW(uinpp::parse_int_list(""), std::runtime_error);
+  EXPECT_THROW(uinpp::parse_int_list(","), std::runtime_error);
+  EXPECT_THROW(uinpp::parse_int_list("1,"), std::runtime_error);
+  EXPECT_THROW(uinpp::parse_int_list("1,,4"), std::runtime_error);
+  EXPECT_THROW(uinpp::parse_int_list("1;4"), std::runtime_error);
+  EXPECT_THROW(uinpp::parse_int_list("4x"), std::runtime_error);
+  EXPECT_THROW(uinpp::parse_int_list("99999999999"), std::runtime_error);
+}
+
+/* EOF */
@@ -0,0 +1,146 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device.hpp"
+#include "device_stats.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+#include "pen_tablet.hpp"
+
+namespace {
+
+uint32_t const tablet_id = uinpp::create_device_id(0, 1);
+
+using uinpp_test::Ev;
+
+class PenTabletTest : public ::testing::Test
+{
+protected:
+  PenTabletTest() :
+    m_uinput(),
+    m_tablet()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_tablet = std::make_unique<uinpp::PenTablet>(m_uinput, tablet_id,
+                                                  uinpp::PenTabletConfig{.has_eraser = true});
+    m_uinput.finish();
+  }
+
+  uinpp::Device* get_device()
+  {
+    return m_uinput.get_devices().front();
+  }
+
+  /** send() the sample and return what was written */
+  std::vector<Ev> send(uinpp::PenSample const& sample)
+  {
+    m_tablet->send(sample);
+
+    return uinpp_test::read_loopback_evs(get_device()->get_loopback_fd());
+  }
+
+  uinpp::MultiDevice m_uinput;
+  std::unique_ptr<uinpp::PenTablet> m_tablet;
+};
+
+} // namespace
+
+TEST_F(PenTabletTest, capabilities)
+{
+  uinpp::Device const* device = get_device();
+  EXPECT_EQ(device->get_type(), uinpp::DeviceType::TABLET);
+
+  uinpp::CapabilitySet const& caps = device->get_capabilities();
+  EXPECT_TRUE(caps.has_prop(INPUT_PROP_DIRECT));
+  EXPECT_TRUE(caps.has_key(BTN_TOOL_PEN));
+  EXPECT_TRUE(caps.has_key(BTN_TOOL_RUBBER));
+  EXPECT_TRUE(caps.has_key(BTN_TOUCH));
+  EXPECT_TRUE(caps.has_key(BTN_STYLUS));
+  EXPECT_EQ(caps.get_absinfo(ABS_X)->resolution, 100);
+  EXPECT_EQ(caps.get_absinfo(ABS_PRESSURE)->maximum, 4095);
+  EXPECT_EQ(caps.get_absinfo(ABS_TILT_Y)->minimum, -64);
+}
+
+TEST_F(PenTabletTest, stroke)
+{
+  using uinpp::PenTool;
+
+  // out of proximity, nothing to send
+  EXPECT_TRUE(send({false, PenTool::PEN, 0, 0, 0, 0, 0, 0}).empty());
+
+  EXPECT_EQ(send({true, PenTool::PEN, 100, 200, 0, 5, -5, 0}), (std::vector<Ev>{
+        {EV_ABS, ABS_X, 100},
+        {EV_ABS, ABS_Y, 200},
+        {EV_ABS, ABS_TILT_X, 5},
+        {EV_ABS, ABS_TILT_Y, -5},
+        {EV_KEY, BTN_TOOL_PEN, 1},
+        {EV_SYN, SYN_REPORT, 0}}));
+
+  // nothing changed, nothing send
+  EXPECT_TRUE(send({true, PenTool::PEN, 100, 200, 0, 5, -5, 0}).empty());
+
+  // tip down, only the changed fields
+  EXPECT_EQ(send({true, PenTool::PEN, 100, 210, 800, 5, -5, uinpp::PEN_BUTTON_STYLUS}), (std::vector<Ev>{
+        {EV_ABS, ABS_Y, 210},
+        {EV_ABS, ABS_PRESSURE, 800},
+        {EV_KEY, BTN_TOUCH, 1},
+        {EV_KEY, BTN_STYLUS, 1},
+        {EV_SYN, SYN_REPORT, 0}}));
+
+  // leaving proximity releases the tip first
+  EXPECT_EQ(send({false, PenTool::PEN, 0, 0, 0, 0, 0, 0}), (std::vector<Ev>{
+        {EV_ABS, ABS_PRESSURE, 0},
+        {EV_KEY, BTN_TOUCH, 0},
+        {EV_KEY, BTN_STYLUS, 0},
+        {EV_SYN, SYN_REPORT, 0},
+        {EV_KEY, BTN_TOOL_PEN, 0},
+        {EV_SYN, SYN_REPORT, 0}}));
+}
+
+TEST_F(PenTabletTest, tool_switch)
+{
+  using uinpp::PenTool;
+
+  send({true, PenTool::PEN, 100, 200, 0, 0, 0, 0});
+  EXPECT_EQ(send({true, PenTool::ERASER, 100, 200, 0, 0, 0, 0}), (std::vector<Ev>{
+        {EV_KEY, BTN_TOOL_PEN, 0},
+        {EV_SYN, SYN_REPORT, 0},
+        {EV_KEY, BTN_TOOL_RUBBER, 1},
+        {EV_SYN, SYN_REPORT, 0}}));
+}
+
+TEST_F(PenTabletTest, send_batch_is_one_write)
+{
+  using uinpp::PenTool;
+
+  std::vector<uinpp::PenSample> const samples = {
+    {true, PenTool::PEN, 100, 200, 100, 0, 0, 0},
+    {true, PenTool::PEN, 110, 200, 200, 0, 0, 0},
+    {true, PenTool::PEN, 120, 200, 300, 0, 0, 0},
+  };
+
+  uint64_t const write_calls = get_device()->get_stats().write_calls;
+  m_tablet->send_batch(samples);
+  EXPECT_EQ(get_device()->get_stats().write_calls, write_calls + 1);
+}
+
+/* EOF */
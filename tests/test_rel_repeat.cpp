@@ -0,0 +1,124 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+class RelRepeatTest : public ::testing::Test
+{
+protected:
+  RelRepeatTest() :
+    m_uinput(),
+    m_rel_x(uinpp::Event::create(uinpp::DEVICEID_MOUSE, EV_REL, REL_X))
+  {
+    m_rel_x.resolve_device_id(0, true);
+
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_uinput.add_rel(m_rel_x.get_device_id(), REL_X);
+    m_uinput.finish();
+  }
+
+  /** REL_X values written since the last call */
+  std::vector<int> read_rel_x()
+  {
+    m_uinput.sync();
+
+    std::vector<int> values;
+    for (input_event const& ev : uinpp_test::read_loopback(m_uinput.get_devices().front()->get_loopback_fd())) {
+      if (ev.type == EV_REL && ev.code == REL_X) {
+        values.push_back(ev.value);
+      }
+    }
+    return values;
+  }
+
+  uinpp::MultiDevice m_uinput;
+  uinpp::Event m_rel_x;
+};
+
+int sum(std::vector<int> const& values)
+{
+  int result = 0;
+  for (int value : values) {
+    result += value;
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_F(RelRepeatTest, keeps_fraction_across_ticks)
+{
+  m_uinput.send_rel_repetitive(m_rel_x, 2.5f, 10);
+  EXPECT_EQ(read_rel_x(), std::vector<int>{2});
+
+  int total = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    m_uinput.update(1);
+    std::vector<int> const values = read_rel_x();
+    EXPECT_LE(values.size(), 1u);
+    total += sum(values);
+  }
+
+  // 2.5 + 1000ms * 2.5 / 10ms = 252.5, the half is still pending
+  EXPECT_EQ(2 + total, 252);
+
+  m_uinput.send_rel_repetitive(m_rel_x, 0.0f, -1);
+  EXPECT_EQ(read_rel_x(), std::vector<int>{1});
+}
+
+TEST_F(RelRepeatTest, late_tick_sends_single_event)
+{
+  m_uinput.send_rel_repetitive(m_rel_x, -3.0f, 10);
+  read_rel_x();
+
+  m_uinput.update(100);
+  EXPECT_EQ(read_rel_x(), std::vector<int>{-30});
+}
+
+TEST_F(RelRepeatTest, tick_rate_independent)
+{
+  m_uinput.send_rel_repetitive(m_rel_x, 1.0f, 3);
+  read_rel_x();
+
+  // 10ms ticks
+  int slow = 0;
+  for (int i = 0; i < 30; ++i) {
+    m_uinput.update(10);
+    slow += sum(read_rel_x());
+  }
+
+  // 1ms ticks
+  int fast = 0;
+  for (int i = 0; i < 300; ++i) {
+    m_uinput.update(1);
+    fast += sum(read_rel_x());
+  }
+
+  EXPECT_EQ(slow, 100);
+  EXPECT_EQ(fast, 100);
+}
+
+/* EOF */
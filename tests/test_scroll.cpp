@@ -0,0 +1,129 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include "device.hpp"
+#include "event_emitter.hpp"
+#include "loopback_reader.hpp"
+#include "multi_device.hpp"
+#include "parse.hpp"
+
+namespace {
+
+uint32_t const mouse_id = uinpp::create_device_id(0, uinpp::DEVICEID_MOUSE);
+
+/** sum of the EV_REL values per code written to \a uinput since the last call */
+std::map<int, int> sum_rel(uinpp::MultiDevice& uinput)
+{
+  uinput.sync();
+
+  std::map<int, int> values;
+  for (input_event const& ev : uinpp_test::read_loopback(uinput.get_devices().front()->get_loopback_fd())) {
+    if (ev.type == EV_REL) {
+      values[ev.code] += ev.value;
+    }
+  }
+  return values;
+}
+
+class ScrollTest : public ::testing::Test
+{
+protected:
+  ScrollTest() :
+    m_uinput()
+  {
+    m_uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_wheel = m_uinput.add_rel(mouse_id, REL_WHEEL);
+    m_uinput.finish();
+  }
+
+  std::map<int, int> read_rel() { return sum_rel(m_uinput); }
+
+  uinpp::MultiDevice m_uinput;
+  uinpp::EventEmitter* m_wheel = nullptr;
+};
+
+} // namespace
+
+TEST_F(ScrollTest, mouse_has_hires_wheel)
+{
+  uinpp::CapabilitySet const& caps = m_uinput.get_devices().front()->get_capabilities();
+  EXPECT_TRUE(caps.has_rel(REL_WHEEL));
+  EXPECT_TRUE(caps.has_rel(REL_HWHEEL));
+  EXPECT_TRUE(caps.has_rel(REL_WHEEL_HI_RES));
+  EXPECT_TRUE(caps.has_rel(REL_HWHEEL_HI_RES));
+}
+
+TEST_F(ScrollTest, legacy_wheel_is_mirrored)
+{
+  m_wheel->send(-2);
+  std::map<int, int> const values = read_rel();
+  EXPECT_EQ(values.at(REL_WHEEL), -2);
+  EXPECT_EQ(values.at(REL_WHEEL_HI_RES), -240);
+}
+
+TEST_F(ScrollTest, own_hires_emitter_is_not_mirrored)
+{
+  uinpp::MultiDevice uinput;
+  uinput.set_backend(uinpp::DeviceBackend::LOOPBACK);
+  uinpp::EventEmitter* wheel = uinput.add_rel(mouse_id, REL_WHEEL);
+  uinpp::EventEmitter* hwheel = uinput.add_rel(mouse_id, REL_HWHEEL);
+  uinput.add_rel(mouse_id, REL_WHEEL_HI_RES);
+  uinput.finish();
+
+  wheel->send(1);
+  hwheel->send(1);
+  EXPECT_EQ(sum_rel(uinput), (std::map<int, int>{{REL_WHEEL, 1}, {REL_HWHEEL, 1}, {REL_HWHEEL_HI_RES, 120}}));
+}
+
+TEST_F(ScrollTest, notches_derived_from_hires)
+{
+  m_uinput.send_scroll(mouse_id, REL_WHEEL, 100);
+  EXPECT_EQ(read_rel(), (std::map<int, int>{{REL_WHEEL_HI_RES, 100}}));
+
+  m_uinput.send_scroll(mouse_id, REL_WHEEL, 100);
+  EXPECT_EQ(read_rel(), (std::map<int, int>{{REL_WHEEL_HI_RES, 100}, {REL_WHEEL, 1}}));
+
+  // changing direction starts a new notch
+  m_uinput.send_scroll(mouse_id, REL_WHEEL, -100);
+  EXPECT_EQ(read_rel(), (std::map<int, int>{{REL_WHEEL_HI_RES, -100}}));
+}
+
+TEST_F(ScrollTest, velocity)
+{
+  m_uinput.set_scroll_velocity(mouse_id, REL_HWHEEL, 2.5f);
+
+  std::map<int, int> total;
+  for (int i = 0; i < 1000; ++i)
+  {
+    m_uinput.update(1);
+    for (auto const& it : read_rel()) {
+      total[it.first] += it.second;
+    }
+  }
+
+  EXPECT_EQ(total[REL_HWHEEL_HI_RES], 300);
+  EXPECT_EQ(total[REL_HWHEEL], 2);
+
+  m_uinput.set_scroll_velocity(mouse_id, REL_HWHEEL, 0.0f);
+  m_uinput.update(100);
+  EXPECT_TRUE(read_rel().empty());
+}
+
+/* EOF */
@@ -0,0 +1,216 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "device.hpp"
+#include "loopback_reader.hpp"
+
+namespace {
+
+class SendStatusTest : public ::testing::Test
+{
+protected:
+  SendStatusTest() :
+    m_device(uinpp::DeviceType::GENERIC, "test", input_id{ BUS_VIRTUAL, 0, 0, 0 }),
+    m_value(0)
+  {
+    m_device.set_backend(uinpp::DeviceBackend::LOOPBACK);
+    m_device.add_abs(ABS_X, 0, 1 << 24);
+    m_device.finish();
+  }
+
+  /** send a frame with the next ABS_X value */
+  uinpp::SendStatus send_frame()
+  {
+    m_value += 1;
+    uinpp::SendStatus const status = m_device.try_send(EV_ABS, ABS_X, m_value);
+    return std::max(status, m_device.try_sync());
+  }
+
+  /** send frames until the loopback socket is full */
+  void fill_socket()
+  {
+    for (int i = 0; i < 100000; ++i) {
+      if (send_frame() == uinpp::SendStatus::QUEUED) {
+        return;
+      }
+    }
+    FAIL() << "loopback socket never filled up";
+  }
+
+  /** ABS_X values that reached the other end */
+  std::vector<int> drain()
+  {
+    std::vector<int> values;
+    for (input_event const& ev : uinpp_test::read_loopback(m_device.get_loopback_fd())) {
+      if (ev.type == EV_ABS) {
+        values.push_back(ev.value);
+      }
+    }
+    return values;
+  }
+
+  uinpp::Device m_device;
+  int m_value;
+};
+
+} // namespace
+
+TEST_F(SendStatusTest, ok)
+{
+  EXPECT_EQ(send_frame(), uinpp::SendStatus::OK);
+  EXPECT_FALSE(m_device.has_pending());
+  EXPECT_EQ(drain(), std::vector<int>{1});
+}
+
+TEST_F(SendStatusTest, queued_frames_keep_their_order)
+{
+  fill_socket();
+  EXPECT_TRUE(m_device.has_pending());
+
+  // newer frames line up behind the queue, even if there is room again
+  EXPECT_EQ(send_frame(), uinpp::SendStatus::QUEUED);
+  std::vector<int> values = drain();
+  EXPECT_EQ(send_frame(), uinpp::SendStatus::OK);
+  EXPECT_FALSE(m_device.has_pending());
+
+  std::vector<int> const rest = drain();
+  values.insert(values.end(), rest.begin(), rest.end());
+
+  ASSERT_EQ(values.size(), static_cast<size_t>(m_value));
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], static_cast<int>(i) + 1);
+  }
+  EXPECT_EQ(m_device.get_stats().dropped_frames, 0u);
+}
+
+TEST_F(SendStatusTest, flush)
+{
+  fill_socket();
+  EXPECT_EQ(m_device.flush(), uinpp::SendStatus::QUEUED);
+
+  drain();
+  EXPECT_EQ(m_device.flush(), uinpp::SendStatus::OK);
+  EXPECT_FALSE(m_device.has_pending());
+  EXPECT_GT(m_device.get_stats().retried_events, 0u);
+}
+
+TEST_F(SendStatusTest, dropped_when_queue_is_full)
+{
+  fill_socket();
+
+  uinpp::SendStatus status = uinpp::SendStatus::QUEUED;
+  for (int i = 0; i < 1000 && status == uinpp::SendStatus::QUEUED; ++i) {
+    status = send_frame();
+  }
+  EXPECT_EQ(status, uinpp::SendStatus::DROPPED);
+  EXPECT_EQ(m_device.get_stats().dropped_frames, 1u);
+
+  // the frames that made it into the queue still arrive in order
+  drain();
+  EXPECT_EQ(m_device.flush(), uinpp::SendStatus::OK);
+  std::vector<int> const values = drain();
+  ASSERT_FALSE(values.empty());
+  EXPECT_EQ(values.back(), m_value - 1);
+}
+
+TEST_F(SendStatusTest, error_behind_queue)
+{
+  // the write to a shut down socket would raise SIGPIPE
+  auto const old_handler = std::signal(SIGPIPE, SIG_IGN);
+
+  fill_socket();
+  ::shutdown(m_device.get_loopback_fd(), SHUT_RD);
+
+  uint64_t const dropped_frames = m_device.get_stats().dropped_frames;
+  EXPECT_EQ(send_frame(), uinpp::SendStatus::ERROR);
+  EXPECT_FALSE(m_device.has_pending());
+  EXPECT_EQ(m_device.get_stats().dropped_frames, dropped_frames + 1);
+
+  // the throwing variants report the error as well
+  m_device.send(EV_ABS, ABS_X, 1);
+  EXPECT_THROW(m_device.sync(), std::runtime_error);
+
+  std::signal(SIGPIPE, old_handler);
+}
+
+TEST_F(SendStatusTest, split_events_are_completed)
+{
+  // a small buffer that isn't a multiple of the event size and frames
+  // larger than what the socket takes in one piece, so that writes
+  // end in the middle of an event
+  int const sndbuf = 5000;
+  ASSERT_EQ(setsockopt(m_device.get_fd(), SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)), 0);
+
+  std::string stream;
+  auto read_bytes = [&]{
+    char buf[1000];
+    ssize_t len;
+    while ((len = ::read(m_device.get_loopback_fd(), buf, sizeof(buf))) > 0) {
+      stream.append(buf, static_cast<size_t>(len));
+    }
+  };
+
+  bool split = false;
+  for (int round = 0; round < 20; ++round)
+  {
+    std::vector<input_event> frame;
+    for (int i = 0; i < 250; ++i) {
+      frame.push_back(input_event{ {}, EV_ABS, ABS_X, ++m_value });
+    }
+    frame.push_back(input_event{ {}, EV_SYN, SYN_REPORT, 0 });
+    ASSERT_NE(m_device.try_send_events(frame), uinpp::SendStatus::DROPPED);
+
+    split = split || m_device.get_stats().bytes_written % sizeof(input_event) != 0;
+
+    // the next frame only fits once the retry queue is written out
+    while (m_device.has_pending()) {
+      read_bytes();
+      m_device.flush();
+    }
+  }
+  read_bytes();
+  EXPECT_TRUE(split);
+
+  ASSERT_EQ(stream.size() % sizeof(input_event), 0u);
+  std::vector<input_event> events(stream.size() / sizeof(input_event));
+  std::memcpy(events.data(), stream.data(), stream.size());
+
+  int value = 0;
+  for (input_event const& ev : events)
+  {
+    if (ev.type == EV_ABS) {
+      ASSERT_EQ(ev.code, ABS_X);
+      ASSERT_EQ(ev.value, value + 1);
+      value = ev.value;
+    } else {
+      ASSERT_EQ(ev.type, EV_SYN);
+    }
+  }
+  EXPECT_EQ(value, m_value);
+}
+
+/* EOF */
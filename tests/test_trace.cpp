@@ -0,0 +1,74 @@
+// uinpp - Linux uinput library for C++
+// Copyright (C) 2008-2022 Ingo Ruhnke <grumbel@gmail.com>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <linux/input.h>
+
+#include "trace.hpp"
+
+TEST(TraceRingTest, disabled_records_nothing)
+{
+  uinpp::TraceRing& ring = uinpp::get_trace_ring();
+  ring.clear();
+
+  uinpp::trace(1, uinpp::TracePhase::SEND, EV_KEY, BTN_A, 1);
+  EXPECT_TRUE(ring.snapshot().empty());
+
+  ring.enable(true);
+  uinpp::trace(1, uinpp::TracePhase::SEND, EV_KEY, BTN_A, 1);
+  ring.enable(false);
+  EXPECT_EQ(ring.snapshot().size(), 1u);
+
+  ring.clear();
+  EXPECT_TRUE(ring.snapshot().empty());
+}
+
+TEST(TraceRingTest, record_and_snapshot)
+{
+  uinpp::TraceRing ring;
+  ring.record(0x10001, uinpp::TracePhase::SEND, EV_ABS, ABS_X, -32768);
+  ring.record(0x10001, uinpp::TracePhase::WRITE, 0, 0, 48);
+
+  std::vector<uinpp::TraceRecord> const records = ring.snapshot();
+  ASSERT_EQ(records.size(), 2u);
+
+  EXPECT_EQ(records[0].device, 0x10001u);
+  EXPECT_EQ(records[0].phase, uinpp::TracePhase::SEND);
+  EXPECT_EQ(records[0].type, EV_ABS);
+  EXPECT_EQ(records[0].code, ABS_X);
+  EXPECT_EQ(records[0].value, -32768);
+
+  EXPECT_EQ(records[1].phase, uinpp::TracePhase::WRITE);
+  EXPECT_EQ(records[1].value, 48);
+  EXPECT_LE(records[0].timestamp, records[1].timestamp);
+}
+
+TEST(TraceRingTest, overwrites_oldest)
+{
+  uinpp::TraceRing ring;
+  int const count = static_cast<int>(uinpp::TraceRing::CAPACITY) + 10;
+  for (int i = 0; i < count; ++i) {
+    ring.record(0, uinpp::TracePhase::SEND, EV_REL, REL_X, i);
+  }
+
+  std::vector<uinpp::TraceRecord> const records = ring.snapshot();
+  ASSERT_EQ(records.size(), uinpp::TraceRing::CAPACITY);
+  EXPECT_EQ(records.front().value, 10);
+  EXPECT_EQ(records.back().value, count - 1);
+}
+
+/* EOF */